@@ -0,0 +1,95 @@
+// clang: MatousFormat
+
+#ifndef MRS_BUMPER_ACCUMULATOR_H
+#define MRS_BUMPER_ACCUMULATOR_H
+
+#include <mrs_msgs/ObstacleSectors.h>
+
+#include <OGRE/OgreMaterial.h>
+
+#include <vector>
+
+namespace Ogre
+{
+  class Vector3;
+  class Quaternion;
+  class ManualObject;
+  class SceneManager;
+  class SceneNode;
+}  // namespace Ogre
+
+namespace mrs_rviz_plugins
+{
+
+  namespace bumper
+  {
+
+    // Accumulates the obstacles from ObstacleSectors messages into a polar
+    // histogram (horizontal sector x distance bin) with an exponential decay.
+    // The histogram is drawn as a single vertex-colored mesh, where the
+    // opacity of each cell corresponds to how often (and how recently) an
+    // obstacle was detected in it.  Unlike keeping a history of Visuals,
+    // the memory and rendering cost do not depend on how long the history is.
+    class Accumulator
+    {
+    public:
+      using msg_t = mrs_msgs::ObstacleSectors;
+
+    public:
+      Accumulator(Ogre::SceneManager* scene_manager, Ogre::SceneNode* parent_node);
+      virtual ~Accumulator();
+
+      // Decays the histogram and adds the obstacles from the message to it.
+      // Only the horizontal sectors are accumulated.
+      void addMessage(const msg_t::ConstPtr& msg);
+
+      // Rebuilds the mesh if the histogram changed since the last call.
+      void update();
+
+      // Forgets all accumulated obstacles.
+      void clear();
+
+      void setFramePosition(const Ogre::Vector3& position);
+      void setFrameOrientation(const Ogre::Quaternion& orientation);
+
+      void setColor(float r, float g, float b, float a);
+
+      // Factor by which the histogram is multiplied with each new message.
+      void setDecay(float decay);
+
+      // Distance covered by the histogram and the number of distance bins.
+      void setRange(float max_range, unsigned n_dist_bins);
+
+      static int accumulator_idx;
+
+    private:
+      void resize(unsigned n_sectors, unsigned n_dist_bins);
+      void redraw();
+
+      unsigned m_n_sectors;
+      unsigned m_n_dist_bins;
+      float m_max_range;
+      float m_decay;
+      float m_color_r, m_color_g, m_color_b, m_color_a;
+      bool m_dirty;
+
+      // values of the cells, the bins of one sector are stored next to each other
+      std::vector<float> m_histogram;
+
+      Ogre::ManualObject* manual_object_;
+      Ogre::MaterialPtr material_;
+
+      // A SceneNode whose pose is set to match the coordinate frame of
+      // the ObstacleSectors message header.
+      Ogre::SceneNode* frame_node_;
+
+      // The SceneManager, kept here only so the destructor can ask it to
+      // destroy the objects.
+      Ogre::SceneManager* scene_manager_;
+    };
+
+  }  // namespace bumper
+
+}  // end namespace mrs_rviz_plugins
+
+#endif  // MRS_BUMPER_ACCUMULATOR_H
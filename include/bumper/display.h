@@ -6,6 +6,8 @@
 #ifndef Q_MOC_RUN
 #include <boost/circular_buffer.hpp>
 
+#include <memory>
+
 #include <rviz/message_filter_display.h>
 #include <mrs_msgs/ObstacleSectors.h>
 #endif
@@ -33,6 +35,7 @@ namespace mrs_rviz_plugins
   {
 
     class Visual;
+    class Accumulator;
 
     class Display : public rviz::MessageFilterDisplay<mrs_msgs::ObstacleSectors>
     {
@@ -54,6 +57,9 @@ namespace mrs_rviz_plugins
       // A helper to clear this display back to the initial state.
       virtual void reset();
 
+      // Called once per render frame, applies the newest received message.
+      virtual void update(float wall_dt, float ros_dt);
+
       // These Qt slots get connected to signals indicating changes in the user-editable properties.
     private Q_SLOTS:
       void updateColorAndAlpha();
@@ -62,15 +68,26 @@ namespace mrs_rviz_plugins
       void updateShowUndetected();
       void updateShowNoData();
       void updateCollisions();
+      void updateHysteresis();
+      void updateAccumulation();
 
       // Function to handle an incoming ROS message.
     private:
       void processMessage(const mrs_msgs::ObstacleSectors::ConstPtr& msg);
+      void applyMessage(const mrs_msgs::ObstacleSectors::ConstPtr& msg);
+
+      // The newest message received since the last render frame.  Messages
+      // arriving faster than the frame rate overwrite each other here, so only
+      // the latest one is transformed and drawn.
+      mrs_msgs::ObstacleSectors::ConstPtr pending_msg_;
 
       // Storage for the list of visuals.  It is a circular buffer where
       // data gets popped from the front (oldest) and pushed to the back (newest)
       boost::circular_buffer<boost::shared_ptr<Visual>> visuals_;
 
+      // Polar histogram of past obstacles, only exists when accumulation is enabled.
+      std::unique_ptr<Accumulator> accumulator_;
+
       // User-editable property variables.
       rviz::ColorProperty* color_property_;
       rviz::FloatProperty* alpha_property_;
@@ -83,6 +100,12 @@ namespace mrs_rviz_plugins
       rviz::EnumProperty* display_mode_property_;
       rviz::BoolProperty* show_undetected_property_;
       rviz::BoolProperty* show_no_data_property_;
+      rviz::FloatProperty* hysteresis_property_;
+      rviz::BoolProperty* accumulate_property_;
+      rviz::FloatProperty* accumulate_alpha_property_;
+      rviz::FloatProperty* accumulate_decay_property_;
+      rviz::FloatProperty* accumulate_range_property_;
+      rviz::IntProperty* accumulate_bins_property_;
     };
 
   }  // namespace bumper
@@ -0,0 +1,118 @@
+// clang: MatousFormat
+
+#ifndef MRS_BUMPER_MULTI_DISPLAY_H
+#define MRS_BUMPER_MULTI_DISPLAY_H
+
+#ifndef Q_MOC_RUN
+#include <ros/ros.h>
+
+#include <rviz/display.h>
+#include <mrs_msgs/ObstacleSectors.h>
+
+#include <OGRE/OgreMaterial.h>
+#include <OGRE/OgreVector3.h>
+#include <OGRE/OgreQuaternion.h>
+
+#include <multi_display/topic_sources.h>
+#endif
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Ogre
+{
+  class ManualObject;
+  class SceneNode;
+}
+
+namespace rviz
+{
+  class BoolProperty;
+  class ColorProperty;
+  class FloatProperty;
+  class StringProperty;
+}  // namespace rviz
+
+namespace mrs_rviz_plugins
+{
+
+  namespace bumper
+  {
+
+    // Displays the bumpers of several UAVs at once.  It subscribes to all
+    // mrs_msgs/ObstacleSectors topics matching a regular expression.  Each
+    // UAV has a scene node carrying the transform of its frame and a single
+    // vertex-colored mesh of its sectors in that frame, so a message only
+    // rebuilds the mesh of its own UAV.  The unit-sized sector shapes are
+    // shared by all UAVs with the same sector layout, each UAV only keeps its
+    // latest message.  Only whole sectors are drawn; sectors without a
+    // detected obstacle or without data are skipped.
+    class MultiDisplay : public rviz::Display
+    {
+      Q_OBJECT
+    public:
+      using msg_t = mrs_msgs::ObstacleSectors;
+
+      MultiDisplay();
+      virtual ~MultiDisplay();
+
+    protected:
+      virtual void onInitialize();
+      virtual void onEnable();
+      virtual void onDisable();
+      virtual void fixedFrameChanged();
+
+      // Called once per render frame, rebuilds the meshes of the bumpers which changed.
+      virtual void update(float wall_dt, float ros_dt);
+
+      // A helper to clear this display back to the initial state.
+      virtual void reset();
+
+    private Q_SLOTS:
+      void updateTopicPattern();
+      void updateAppearance();
+
+    private:
+      struct uav_t : multi_display::TopicSource<msg_t>
+      {
+        std::shared_ptr<Ogre::SceneNode> node;
+        std::shared_ptr<Ogre::ManualObject> object;
+      };
+
+      // Triangle lists of the sector shapes at unit distance, shared by all
+      // UAVs with the same number of horizontal sectors and vertical FOV.
+      struct sector_template_t
+      {
+        std::vector<Ogre::Vector3> horizontal;  // horizontal sector pointing along the x axis
+        std::vector<Ogre::Quaternion> yaws;     // rotations of the individual horizontal sectors
+        std::vector<Ogre::Vector3> topdown;     // upwards pointing vertical sector
+      };
+
+      static bool isValid(const msg_t& msg, const std::string& topic);
+      const sector_template_t& getTemplate(const msg_t& msg);
+      void redraw(uav_t& uav);
+
+      multi_display::TopicSources<msg_t, uav_t> uavs_;
+      std::map<std::pair<unsigned, double>, sector_template_t> templates_;
+      bool dirty_;
+
+      Ogre::MaterialPtr material_;
+
+      // User-editable property variables.
+      rviz::StringProperty* topic_pattern_property_;
+      rviz::ColorProperty* color_property_;
+      rviz::FloatProperty* alpha_property_;
+      rviz::BoolProperty* collision_colorize_property_;
+      rviz::FloatProperty* horizontal_collision_threshold_property_;
+      rviz::FloatProperty* vertical_collision_threshold_property_;
+      rviz::ColorProperty* collision_color_property_;
+      rviz::FloatProperty* collision_alpha_property_;
+    };
+
+  }  // namespace bumper
+
+}  // end namespace mrs_rviz_plugins
+
+#endif  // MRS_BUMPER_MULTI_DISPLAY_H
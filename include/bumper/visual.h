@@ -5,6 +5,8 @@
 
 #include <mrs_msgs/ObstacleSectors.h>
 
+#include <boost/dynamic_bitset.hpp>
+
 namespace Ogre
 {
   class Vector3;
@@ -66,8 +68,16 @@ namespace mrs_rviz_plugins
 
       void setCollisionOptions(bool colorize, float horizontal_threshold, float vertical_threshold, float r, float g, float b, float a);
 
+      // Sectors whose obstacle distance changed by less than this value
+      // since they were last drawn are not redrawn by setMessage().
+      void setHysteresis(float hysteresis);
+
     private:
-      void draw_message(const msg_t::ConstPtr& msg, display_mode_t display_mode);
+      void redraw();
+      void draw_sectors(const boost::dynamic_bitset<>& dirty);
+      bool sector_changed(const unsigned sector_it) const;
+      bool is_colliding(const unsigned sector_it, const double dist) const;
+      std::shared_ptr<rviz::Object> draw_sector_object(const unsigned sector_it);
       std::shared_ptr<rviz::Object> draw_no_data(const unsigned sector_it, const unsigned n_horizontal_sectors);
       std::shared_ptr<rviz::Object> draw_sensor(const double dist, const double vfov, const double hfov, const int sensor_type, const unsigned sector_it,
                                                 const unsigned n_horizontal_sectors);
@@ -88,11 +98,15 @@ namespace mrs_rviz_plugins
       float m_collision_horizontal_threshold;
       float m_collision_vertical_threshold;
       float m_collision_color_r, m_collision_color_g, m_collision_color_b, m_collision_color_a;
+      float m_hysteresis;
 
       msg_t::ConstPtr m_msg;
       display_mode_t m_display_mode;
-      // The object implementing the actual Object
+      // The objects implementing the actual sectors, indexed by the sector index (nullptr if the sector is not shown)
       std::vector<std::shared_ptr<rviz::Object>> m_sectors;
+      // The distances and sensor types the sectors in m_sectors were drawn with
+      std::vector<double> m_drawn_lens;
+      std::vector<int> m_drawn_sensors;
 
       // A SceneNode whose pose is set to match the coordinate frame of
       // the MRS_Bumper_ message header.
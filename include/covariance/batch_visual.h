@@ -0,0 +1,167 @@
+#ifndef COVARIANCE_BATCH_VISUAL_H
+#define COVARIANCE_BATCH_VISUAL_H
+
+#include <covariance/visual.h>
+
+#include <OgreMaterial.h>
+#include <OgreVector3.h>
+#include <OgreQuaternion.h>
+#include <OgreColourValue.h>
+
+#include <vector>
+
+namespace Ogre
+{
+class Camera;
+class SceneManager;
+class SceneNode;
+class ManualObject;
+}  // namespace Ogre
+
+namespace mrs_rviz_plugins
+{
+
+namespace covariance
+{
+
+class ShapeCache;
+
+/**
+ * \class BatchVisual
+ * \brief Draws the covariances of many poses in two draw calls
+ *
+ * Unlike Visual, which creates a sphere and four cylinder or cone entities with their own
+ * materials and scene nodes for every pose, all position ellipsoids are drawn into a single
+ * vertex-colored mesh and all orientation shapes into another one. The placement of the shapes
+ * is the same as with Visual, it is only computed on the CPU when the meshes are rebuilt.
+ *
+ * The covariances are culled against the camera every frame. Those outside of the view frustum
+ * or smaller than a pixel are left out of the meshes and their shapes are not computed until
+ * they become visible, the small ones are drawn with low-poly meshes.
+ */
+class BatchVisual {
+public:
+  /**
+   * \brief Constructor
+   *
+   * @param scene_manager The scene manager to use to construct any necessary objects
+   * @param parent_node The scene node the poses of the covariances are relative to
+   * @param is_local_rotation Initial attachment of the rotation part
+   */
+  BatchVisual(Ogre::SceneManager* scene_manager, Ogre::SceneNode* parent_node, bool is_local_rotation);
+  virtual ~BatchVisual();
+
+  /**
+   * \brief Remove all covariances
+   */
+  void clear();
+
+  /**
+   * \brief Add a covariance
+   *
+   * @param position Position of the pose in the frame of the parent node
+   * @param orientation Orientation of the pose in the frame of the parent node
+   * @param pose The pose with covariance as received, its shape is computed once it is visible
+   */
+  void add(const Ogre::Vector3& position, const Ogre::Quaternion& orientation, const geometry_msgs::PoseWithCovariance& pose);
+
+  /**
+   * \brief Add a covariance given by flat arrays
+   *
+   * @param position Position of the pose in the frame of the parent node
+   * @param orientation Orientation of the pose in the frame of the parent node
+   * @param source_position x, y, z of the pose as received
+   * @param source_orientation x, y, z, w of the pose as received
+   * @param covariance Row-major 6x6 covariance matrix
+   */
+  void add(const Ogre::Vector3& position, const Ogre::Quaternion& orientation, const double* source_position, const double* source_orientation,
+           const double* covariance);
+
+  /**
+   * \brief Use a cache for the shapes of the covariances, nullptr to compute all of them
+   */
+  void setShapeCache(ShapeCache* cache);
+
+  /**
+   * \brief Cull the covariances and rebuild the meshes if the visible ones or their appearance changed
+   *
+   * Meant to be called every frame.
+   *
+   * @param camera The camera the covariances are culled against, nullptr to draw all of them in full detail
+   */
+  void update(const Ogre::Camera* camera);
+
+  // The same setters as of Visual, they apply to all the covariances
+  void setPositionScale(float pos_scale);
+  void setOrientationOffset(float ori_offset);
+  void setOrientationScale(float ori_scale);
+  void setPositionColor(float r, float g, float b, float a);
+  void setOrientationColor(float r, float g, float b, float a);
+  void setOrientationColorToRGB(float a);
+  void setVisible(bool visible);
+  void setPositionVisible(bool visible);
+  void setOrientationVisible(bool visible);
+  void setRotatingFrame(bool use_rotating_frame);
+
+  /**
+   * \brief Get the scene node both meshes are attached to
+   */
+  Ogre::SceneNode* getSceneNode() {
+    return root_node_;
+  }
+
+  Ogre::ManualObject* getPositionObject() {
+    return position_object_;
+  }
+
+  Ogre::ManualObject* getOrientationObject() {
+    return orientation_object_;
+  }
+
+private:
+  struct Instance
+  {
+    Ogre::Vector3                     position;
+    Ogre::Quaternion                  orientation;
+    geometry_msgs::PoseWithCovariance source;
+    double                            position_sigma;     ///< Upper bound on the standard deviation of the position
+    double                            orientation_sigma;  ///< Upper bound on the standard deviation of the orientation
+    bool                              has_shape;
+    Visual::Shape                     shape;
+    int                               position_lod;     ///< Level of detail of the meshes, -1 if culled
+    int                               orientation_lod;
+  };
+
+  void computeShapes(const std::vector<size_t>& indices);
+
+  void redraw();
+  void redrawPosition();
+  void redrawOrientation();
+
+  std::vector<Instance> instances_;
+  ShapeCache*           cache_;
+
+  Ogre::SceneManager* scene_manager_;
+  Ogre::SceneNode*    root_node_;
+  Ogre::ManualObject* position_object_;
+  Ogre::ManualObject* orientation_object_;
+  Ogre::MaterialPtr   position_material_;
+  Ogre::MaterialPtr   orientation_material_;
+
+  bool              local_rotation_;
+  bool              dirty_;
+  float             pos_scale_;
+  float             ori_offset_;
+  float             ori_scale_;
+  Ogre::ColourValue pos_color_;
+  Ogre::ColourValue ori_color_;
+  bool              ori_color_rgb_;
+
+  static int batch_visual_idx;
+};
+
+}  // namespace covariance
+
+}  // namespace mrs_rviz_plugins
+
+#endif /* COVARIANCE_BATCH_VISUAL_H */
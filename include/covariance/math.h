@@ -0,0 +1,66 @@
+#ifndef COVARIANCE_MATH_H
+#define COVARIANCE_MATH_H
+
+#include <Eigen/Dense>
+
+#include <OgreVector3.h>
+#include <OgreQuaternion.h>
+
+namespace mrs_rviz_plugins
+{
+
+namespace covariance
+{
+
+/*
+ * The math behind Visual::computeShape(). It does not depend on any Ogre scene objects,
+ * so it can be checked and timed on its own.
+ */
+
+enum Plane
+{
+  YZ_PLANE,  // normal is x-axis
+  XZ_PLANE,  // normal is y-axis
+  XY_PLANE   // normal is z-axis
+};
+
+double deg2rad(double degrees);
+
+/**
+ * \brief Reorder the eigenvectors, and the eigenvalues with them, so that they form a right-handed system
+ */
+void makeRightHanded(Eigen::Matrix3d& eigenvectors, Eigen::Vector3d& eigenvalues);
+void makeRightHanded(Eigen::Matrix2d& eigenvectors, Eigen::Vector2d& eigenvalues);
+
+/**
+ * \brief Eigen decomposition of a symmetric matrix, the eigenvalues are sorted in increasing order
+ *
+ * Only the lower triangular part of the matrix is referenced.
+ *
+ * @return false if the decomposition failed
+ */
+bool eigenDecomposition3D(const Eigen::Matrix3d& covariance, Eigen::Vector3d& eigenvalues, Eigen::Matrix3d& eigenvectors);
+bool eigenDecomposition2D(const Eigen::Matrix2d& covariance, Eigen::Vector2d& eigenvalues, Eigen::Matrix2d& eigenvectors);
+
+/**
+ * \brief Scale and orientation of the ellipsoid of a 3x3 covariance, the scales are two standard deviations
+ */
+void computeShapeScaleAndOrientation3D(const Eigen::Matrix3d& covariance, Ogre::Vector3& scale, Ogre::Quaternion& orientation);
+
+/**
+ * \brief Scale and orientation of the ellipse of a 2x2 covariance lying in the given plane
+ *
+ * The scale along the normal of the plane is zero.
+ */
+void computeShapeScaleAndOrientation2D(const Eigen::Matrix2d& covariance, Ogre::Vector3& scale, Ogre::Quaternion& orientation, Plane plane = XY_PLANE);
+
+/**
+ * \brief Convert twice an angular standard deviation to the width of a shape at unit distance, bounded by max_degrees
+ */
+void radianScaleToMetricScaleBounded(Ogre::Real& radian_scale, float max_degrees);
+
+}  // namespace covariance
+
+}  // namespace mrs_rviz_plugins
+
+#endif /* COVARIANCE_MATH_H */
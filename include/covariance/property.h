@@ -8,6 +8,7 @@
 #include <rviz/properties/bool_property.h>
 
 #include <covariance/visual.h>
+#include <covariance/batch_visual.h>
 
 namespace Ogre
 {
@@ -31,7 +32,8 @@ namespace covariance
 class Property : public rviz::BoolProperty {
   Q_OBJECT
 public:
-  typedef boost::shared_ptr<Visual> VisualPtr;
+  typedef boost::shared_ptr<Visual>      VisualPtr;
+  typedef boost::shared_ptr<BatchVisual> BatchVisualPtr;
 
   enum Frame
   {
@@ -59,6 +61,9 @@ public:
   void      clearVisual();
   size_t    sizeVisual();
 
+  // Creates a visual drawing many covariances at once, it is kept up to date with the properties as well
+  BatchVisualPtr createBatchVisual(Ogre::SceneManager* scene_manager, Ogre::SceneNode* parent_node);
+
 public Q_SLOTS:
   void updateVisibility();
 
@@ -68,13 +73,19 @@ private Q_SLOTS:
   void updateColorStyleChoice();
 
 private:
-  void updateColorAndAlphaAndScaleAndOffset(const VisualPtr& visual);
-  void updateOrientationFrame(const VisualPtr& visual);
-  void updateVisibility(const VisualPtr& visual);
+  // Applied both to Visual and BatchVisual, which have the same setters
+  template <typename T>
+  void updateColorAndAlphaAndScaleAndOffset(const T& visual);
+  template <typename T>
+  void updateOrientationFrame(const T& visual);
+  template <typename T>
+  void updateVisibility(const T& visual);
 
   typedef std::deque<VisualPtr> D_Covariance;
   D_Covariance                  covariances_;
 
+  std::vector<BatchVisualPtr> batch_visuals_;
+
   rviz::BoolProperty*  position_property_;
   rviz::ColorProperty* position_color_property_;
   rviz::FloatProperty* position_alpha_property_;
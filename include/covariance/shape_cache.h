@@ -0,0 +1,117 @@
+#ifndef COVARIANCE_SHAPE_CACHE_H
+#define COVARIANCE_SHAPE_CACHE_H
+
+#include <covariance/visual.h>
+
+#include <geometry_msgs/Pose.h>
+
+#include <array>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+namespace mrs_rviz_plugins
+{
+
+namespace covariance
+{
+
+/**
+ * \class ShapeCache
+ * \brief Memoizes the shapes computed by Visual::computeShape()
+ *
+ * Sources like stationary tracks or converged estimators publish the same covariance
+ * over and over. The cache is keyed by the covariance and the orientation of the pose,
+ * both quantized by an epsilon, so such covariances are only decomposed once.
+ */
+class ShapeCache {
+public:
+  /**
+   * \brief Constructor
+   *
+   * @param epsilon Values of the covariance and orientation closer than this are considered equal
+   * @param max_size Maximal number of cached shapes, the cache is emptied when it is exceeded
+   */
+  ShapeCache(double epsilon = 1e-9, size_t max_size = 4096);
+
+  /**
+   * \brief Look up a cached shape
+   *
+   * @return true if the shape was found and written to \p shape
+   */
+  bool find(const geometry_msgs::Pose& pose, const double* covariance, Visual::Shape& shape);
+
+  void insert(const geometry_msgs::Pose& pose, const double* covariance, const Visual::Shape& shape);
+
+  /**
+   * \brief Same as Visual::computeShapes(), but only computes the shapes not found in the cache
+   */
+  template <typename InputIt, typename OutputIt>
+  void computeShapes(InputIt first, InputIt last, OutputIt out);
+
+  void clear();
+
+  size_t getHits() const {
+    return hits_;
+  }
+
+  size_t getMisses() const {
+    return misses_;
+  }
+
+  void resetCounters();
+
+private:
+  // 36 elements of the covariance followed by the 4 elements of the orientation
+  typedef std::array<double, 40> Key;
+
+  struct KeyHash
+  {
+    size_t operator()(const Key& key) const;
+  };
+
+  Key makeKey(const geometry_msgs::Pose& pose, const double* covariance) const;
+
+  double epsilon_;
+  size_t max_size_;
+  size_t hits_;
+  size_t misses_;
+
+  std::unordered_map<Key, Visual::Shape, KeyHash> shapes_;
+};
+
+template <typename InputIt, typename OutputIt>
+void ShapeCache::computeShapes(InputIt first, InputIt last, OutputIt out) {
+  typedef typename std::iterator_traits<InputIt>::value_type PoseWithCovariance;
+  // Refers to a pose with covariance missing in the cache, has the members Visual::computeShapes() expects
+  struct Miss
+  {
+    const geometry_msgs::Pose&                           pose;
+    const typename PoseWithCovariance::_covariance_type& covariance;
+  };
+
+  std::vector<Miss>   misses;
+  std::vector<size_t> miss_indices;
+  size_t              index = 0;
+  for (InputIt it = first; it != last; ++it, ++index) {
+    if (!find(it->pose, it->covariance.data(), out[index])) {
+      misses.push_back(Miss{it->pose, it->covariance});
+      miss_indices.push_back(index);
+    }
+  }
+  if (misses.empty())
+    return;
+
+  std::vector<Visual::Shape> computed(misses.size());
+  Visual::computeShapes(misses.begin(), misses.end(), computed.begin());
+  for (size_t it = 0; it < misses.size(); it++) {
+    insert(misses[it].pose, misses[it].covariance.data(), computed[it]);
+    out[miss_indices[it]] = computed[it];
+  }
+}
+
+}  // namespace covariance
+
+}  // namespace mrs_rviz_plugins
+
+#endif /* COVARIANCE_SHAPE_CACHE_H */
@@ -1,7 +1,12 @@
 #ifndef COVARIANCE_VISUAL_H
 #define COVARIANCE_VISUAL_H
 
+#include <algorithm>
 #include <cmath>
+#include <future>
+#include <iterator>
+#include <thread>
+#include <vector>
 
 #include <rviz/ogre_helpers/object.h>
 
@@ -12,6 +17,7 @@
 #include <Eigen/Dense>
 
 #include <OgreVector3.h>
+#include <OgreQuaternion.h>
 #include <OgreColourValue.h>
 
 namespace Ogre
@@ -100,6 +106,75 @@ public:
   void         setOrientationColor(const Ogre::ColourValue& color);
   void         setOrientationColorToRGB(float a);
 
+  /**
+   * \brief Orientations and scales of the shapes of a single covariance.
+   *
+   * It is only the result of the math done by setCovariance() and does not refer to any
+   * Ogre objects, so it can be computed for a whole message at once, also off the main thread,
+   * and applied to the visuals by setShape() afterwards.
+   */
+  struct Shape
+  {
+    bool             valid   = false;  ///< False if the covariance contained NaNs, such shape is not applied
+    bool             pose_2d = false;
+    Ogre::Quaternion fixed_orientation;
+    Ogre::Vector3    position_scale;
+    Ogre::Quaternion position_orientation;
+    Ogre::Vector3    orientation_scale[kNumOriShapes];  ///< In radians, before the scale factor is applied
+    Ogre::Quaternion orientation_orientation[kNumOriShapes];
+  };
+
+  /**
+   * \brief Compute the shape of a covariance
+   *
+   * @param pose Pose the covariance belongs to
+   * @param covariance Row-major 6x6 covariance matrix
+   * @param shape The result
+   */
+  static void computeShape(const geometry_msgs::Pose& pose, const double* covariance, Shape& shape);
+
+  /**
+   * \brief Compute the shapes of a range of covariances
+   *
+   * The elements of the input range have to provide the \c pose and \c covariance members,
+   * such as geometry_msgs::PoseWithCovariance. Large ranges are split into chunks computed
+   * in parallel by up to \p max_threads threads.
+   *
+   * @param first, last The random-access range of the poses with covariance
+   * @param out The beginning of the random-access range of the resulting shapes
+   * @param max_threads Upper bound on the number of threads, 0 means the number of hardware threads
+   */
+  template <typename InputIt, typename OutputIt>
+  static void computeShapes(InputIt first, InputIt last, OutputIt out, unsigned max_threads = 0);
+
+  /**
+   * \brief Apply a shape computed by computeShape()
+   *
+   * Same as setCovariance() with the pose and covariance the shape was computed from.
+   */
+  void setShape(const Shape& shape);
+
+  /**
+   * \brief Pose of the node placing an orientation shape, relative to the orientation root node
+   */
+  static void getOrientationOffsetPose(ShapeIndex index, Ogre::Vector3& position, Ogre::Quaternion& orientation);
+
+  /**
+   * \brief Scale of the node placing an orientation shape for the given orientation offset
+   */
+  static Ogre::Vector3 getOrientationOffsetScale(ShapeIndex index, float ori_offset);
+
+  /**
+   * \brief Convert the scale of an orientation shape computed by computeShape() to its metric scale
+   *
+   * @param radian_scale Scale of the shape in radians, Shape::orientation_scale
+   * @param ori_scale Scale of the orientation covariance
+   */
+  static Ogre::Vector3 getOrientationMetricScale(ShapeIndex index, const Ogre::Vector3& radian_scale, float ori_scale);
+
+  /// Bound on the angle spanned by an orientation shape
+  const static float max_degrees;
+
   /** @brief Set the covariance.
    *
    * This effectively changes the orientation and scale of position and orientation
@@ -178,9 +253,13 @@ public:
   virtual void setRotatingFrame(bool use_rotating_frame);
 
 private:
-  void updatePosition(const Eigen::Matrix6d& covariance);
-  void updateOrientation(const Eigen::Matrix6d& covariance, ShapeIndex index);
-  void updateOrientationVisibility();
+  static void computePositionShape(const Eigen::Matrix6d& covariance, bool pose_2d, Ogre::Vector3& scale, Ogre::Quaternion& orientation);
+  static void computeOrientationShape(const Eigen::Matrix6d& covariance, ShapeIndex index, Ogre::Vector3& scale, Ogre::Quaternion& orientation);
+  void        updateOrientationScale(ShapeIndex index);
+  void        updateOrientationVisibility();
+
+  // Below this number of covariances per thread, computeShapes() does not spawn more threads
+  static constexpr size_t min_shapes_per_thread = 128;
 
   Ogre::SceneNode* root_node_;
   Ogre::SceneNode* fixed_orientation_node_;
@@ -202,8 +281,6 @@ private:
   Ogre::Vector3 current_ori_scale_[kNumOriShapes];
   float         current_ori_scale_factor_;
 
-  const static float max_degrees;
-
 private:
   // Hide Object methods we don't want to expose
   // NOTE: Apparently we still need to define them...
@@ -216,6 +293,34 @@ private:
   friend class Property;
 };
 
+template <typename InputIt, typename OutputIt>
+void Visual::computeShapes(InputIt first, InputIt last, OutputIt out, unsigned max_threads) {
+  const auto compute_range = [](InputIt first, InputIt last, OutputIt out) {
+    for (; first != last; ++first, ++out)
+      computeShape(first->pose, first->covariance.data(), *out);
+  };
+
+  const size_t n_shapes = std::distance(first, last);
+  if (max_threads == 0)
+    max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  const size_t n_chunks = std::min<size_t>(max_threads, n_shapes / min_shapes_per_thread);
+  if (n_chunks <= 1) {
+    compute_range(first, last, out);
+    return;
+  }
+
+  // The first chunk is computed by the calling thread
+  const size_t                   chunk_size = (n_shapes + n_chunks - 1) / n_chunks;
+  std::vector<std::future<void>> futures;
+  for (size_t begin = chunk_size; begin < n_shapes; begin += chunk_size) {
+    const size_t end = std::min(begin + chunk_size, n_shapes);
+    futures.push_back(std::async(std::launch::async, compute_range, first + begin, first + end, out + begin));
+  }
+  compute_range(first, first + chunk_size, out);
+  for (auto& future : futures)
+    future.get();
+}
+
 }  // namespace covariance
 
 }  // namespace mrs_rviz_plugins
@@ -0,0 +1,125 @@
+#ifndef FAST_ARROW_BATCH_H
+#define FAST_ARROW_BATCH_H
+
+#include <OgreVector3.h>
+#include <OgreQuaternion.h>
+#include <OgreColourValue.h>
+#include <OgreMaterial.h>
+#include <OgreAxisAlignedBox.h>
+
+#include <vector>
+
+namespace Ogre
+{
+class SceneManager;
+class SceneNode;
+class ManualObject;
+class Any;
+} // namespace Ogre
+
+namespace rviz
+{
+
+/*
+ * Many arrows of the same shape as FastArrow drawn by a single line list.
+ *
+ * The arrows are addressed by the index returned by add(). The setters only store the new
+ * pose or color, update() then rebuilds the line list if arrows were added or their shape
+ * changed, otherwise it rewrites just the vertices of the modified arrows.
+ */
+class FastArrowBatch
+{
+public:
+  FastArrowBatch(Ogre::SceneManager* scene_manager,
+                 Ogre::SceneNode* parent_node = nullptr,
+                 float shaft_length = 1.0f,
+                 float head_length = 0.3f,
+                 float head_diameter = 0.2f);
+  ~FastArrowBatch();
+
+  // Adds an arrow with the identity pose and the color of the batch, returns its index
+  size_t add();
+  // Adds or removes arrows at the end, the remaining ones keep their poses and colors
+  void resize(size_t size);
+  void clear();
+  size_t size() const;
+
+  // The shape of all the arrows
+  void set(float shaft_length, float head_length, float head_diameter);
+
+  // Without the heads, each arrow is a single line showing the heading of its pose
+  void setHeadsVisible(bool visible);
+
+  // Sets the color of all the arrows
+  void setColor(float r, float g, float b, float a);
+  void setColor(const Ogre::ColourValue& color);
+
+  // The same as the setters of FastArrow, for the arrow with the given index
+  void setColor(size_t index, const Ogre::ColourValue& color);
+  void setPosition(size_t index, const Ogre::Vector3& position);
+  void setOrientation(size_t index, const Ogre::Quaternion& orientation);
+  void setDirection(size_t index, const Ogre::Vector3& direction);
+
+  // Uploads the changes made since the last call
+  void update();
+
+  Ogre::SceneNode* getSceneNode()
+  {
+    return scene_node_;
+  }
+
+  Ogre::ManualObject* getManualObject()
+  {
+    return manual_object_;
+  }
+
+  void setUserData(const Ogre::Any& data);
+
+private:
+  struct Arrow
+  {
+    Ogre::Vector3 position;
+    Ogre::Quaternion orientation;
+    Ogre::ColourValue color;
+    bool dirty;
+  };
+
+  // The shaft comes first, followed by the two lines of the head
+  static const size_t max_vertices_per_arrow = 6;
+  // Above this fraction of modified arrows, the whole line list is rebuilt instead
+  static constexpr double max_dirty_fraction = 0.25;
+  // Clean arrows between two modified ones are rewritten as well if there are at most this many,
+  // so that nearby changes are uploaded by a single write
+  static const size_t max_rewrite_gap = 32;
+
+  size_t verticesPerArrow() const;
+  void markDirty(size_t index);
+  void getVertices(const Arrow& arrow, Ogre::Vector3 (&vertices)[max_vertices_per_arrow]) const;
+  void updateTransparency();
+  void rebuild();
+  void rewriteDirty();
+  void writeRange(size_t first, size_t last, std::vector<unsigned char>& staging);
+
+  Ogre::SceneManager* scene_manager_;
+  Ogre::SceneNode* scene_node_;
+  Ogre::ManualObject* manual_object_;
+  Ogre::MaterialPtr material_;
+
+  std::vector<Arrow> arrows_;
+  std::vector<size_t> dirty_arrows_;
+  bool rebuild_;
+  size_t n_transparent_;
+  Ogre::AxisAlignedBox bounding_box_;
+
+  Ogre::ColourValue color_;
+  float shaft_length_;
+  float head_length_;
+  float head_diameter_;
+  bool heads_visible_;
+
+  static int batch_idx;
+};
+
+} // namespace rviz
+
+#endif /* FAST_ARROW_BATCH_H */
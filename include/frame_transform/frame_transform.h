@@ -0,0 +1,35 @@
+#ifndef FRAME_TRANSFORM_FRAME_TRANSFORM_H
+#define FRAME_TRANSFORM_FRAME_TRANSFORM_H
+
+#include <OgreVector3.h>
+#include <OgreQuaternion.h>
+
+namespace mrs_rviz_plugins
+{
+
+namespace frame_transform
+{
+
+/**
+ * \brief Transform a pose to the fixed frame by a transform looked up once for the whole message
+ *
+ * Same as rviz::FrameManager::transform(), the orientation is normalized and a zero quaternion is the identity.
+ *
+ * @param frame_position, frame_orientation The transform from the frame of the message to the fixed frame
+ * @param position, orientation The pose in the frame of the message
+ * @param out_position, out_orientation The pose in the fixed frame
+ */
+inline void applyFrameTransform(const Ogre::Vector3& frame_position, const Ogre::Quaternion& frame_orientation, const Ogre::Vector3& position,
+                                Ogre::Quaternion orientation, Ogre::Vector3& out_position, Ogre::Quaternion& out_orientation) {
+  if (orientation.Norm() == 0.0)
+    orientation = Ogre::Quaternion::IDENTITY;
+  orientation.normalise();
+  out_position    = frame_position + frame_orientation * position;
+  out_orientation = frame_orientation * orientation;
+}
+
+}  // namespace frame_transform
+
+}  // namespace mrs_rviz_plugins
+
+#endif /* FRAME_TRANSFORM_FRAME_TRANSFORM_H */
@@ -0,0 +1,75 @@
+// clang: MatousFormat
+
+#ifndef LOD_SCREEN_SIZE_H
+#define LOD_SCREEN_SIZE_H
+
+#include <OGRE/OgreCamera.h>
+#include <OGRE/OgreViewport.h>
+#include <OGRE/OgreVector3.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace mrs_rviz_plugins
+{
+
+  // Helpers to select the level of detail of the meshes from their size on the
+  // screen, shared by the displays which draw circles or covariance shapes.
+  namespace lod
+  {
+
+    // Returns the radius in pixels of a sphere with the given center and radius
+    // (in world coordinates) when rendered by the camera.  Zero if the camera has
+    // no viewport or the sphere is behind it, infinite if the camera is inside of it.
+    inline float screenRadius(const Ogre::Camera* cam, const Ogre::Vector3& center, const float radius)
+    {
+      const Ogre::Viewport* viewport = cam->getViewport();
+      if (!viewport)
+        return 0.0f;
+
+      // the w coordinate of the center in clip space is the depth for perspective projections and 1 for orthographic ones
+      const Ogre::Vector3 center_eye = cam->getViewMatrix(true) * center;
+      const Ogre::Matrix4& proj = cam->getProjectionMatrix();
+      const float w = proj[3][0] * center_eye.x + proj[3][1] * center_eye.y + proj[3][2] * center_eye.z + proj[3][3];
+      // for perspective projections, the camera may be inside of the sphere or the sphere may be behind the camera
+      const bool perspective = proj[3][3] == 0.0f;
+      if (perspective && w <= radius)
+        return w <= -radius ? 0.0f : std::numeric_limits<float>::infinity();
+
+      return radius * proj[1][1] / w * viewport->getActualHeight() / 2.0f;
+    }
+
+    // Returns the coarsest level of detail, given by the number of segments around
+    // a circle ordered from the coarsest to the finest, which keeps the deviation of
+    // the drawn polygon from a circle with the given radius under half a pixel.
+    template <size_t N>
+    int selectLod(const float screen_radius, const std::array<int, N>& lod_segments)
+    {
+      // the sagitta of a segment is r*(1 - cos(pi/n)) ~ r*pi^2/(2*n^2), which is below half a pixel for n >= pi*sqrt(r)
+      const float min_segments = M_PI * std::sqrt(screen_radius);
+      for (size_t lod_it = 0; lod_it < N; lod_it++)
+        if (lod_segments.at(lod_it) >= min_segments)
+          return lod_it;
+      return N - 1;
+    }
+
+    // Same as above, but a finer level than the selected one which is in use as
+    // `current` is kept until the sphere would get the coarser level even if it
+    // was `hysteresis` times larger.  Without it, the meshes of a sphere which
+    // hovers around a threshold while the camera moves are rebuilt every frame.
+    template <size_t N>
+    int selectLod(const float screen_radius, const std::array<int, N>& lod_segments, const int current, const float hysteresis)
+    {
+      const int lod = selectLod(screen_radius, lod_segments);
+      if (lod >= current)
+        return lod;
+      return std::min(current, selectLod(hysteresis * screen_radius, lod_segments));
+    }
+
+  }  // namespace lod
+
+}  // end namespace mrs_rviz_plugins
+
+#endif // LOD_SCREEN_SIZE_H
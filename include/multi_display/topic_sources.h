@@ -0,0 +1,273 @@
+// clang: MatousFormat
+
+#ifndef MRS_MULTI_DISPLAY_TOPIC_SOURCES_H
+#define MRS_MULTI_DISPLAY_TOPIC_SOURCES_H
+
+#ifndef Q_MOC_RUN
+#include <ros/ros.h>
+#include <ros/master.h>
+
+#include <rviz/display.h>
+#include <rviz/frame_manager.h>
+#include <rviz/properties/status_property.h>
+#include <std_msgs/Header.h>
+
+#include <OGRE/OgreVector3.h>
+#include <OGRE/OgreQuaternion.h>
+
+#include <boost/bind.hpp>
+#endif
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <map>
+#include <regex>
+#include <string>
+#include <type_traits>
+
+namespace mrs_rviz_plugins
+{
+
+  namespace multi_display
+  {
+
+    // The bookkeeping of a single topic, the displays add their own state of
+    // the topic by deriving from it.
+    template <typename MsgT>
+    struct TopicSource
+    {
+      ros::Subscriber sub;
+      typename MsgT::ConstPtr msg;
+      bool new_msg = false;
+      bool valid = false;
+    };
+
+    // Looks up the transform from the fixed frame to the frame of the header.
+    // The multi displays have no MessageFilter waiting for TF, so while the
+    // transform at the stamp has not arrived yet, the latest one is used
+    // instead of hiding the source until its next message.
+    inline bool getTransform(rviz::FrameManager* frame_manager, const std_msgs::Header& header, Ogre::Vector3& position, Ogre::Quaternion& orientation)
+    {
+      return frame_manager->getTransform(header.frame_id, header.stamp, position, orientation) ||
+             frame_manager->getTransform(header.frame_id, ros::Time(), position, orientation);
+    }
+
+    // Subscribes to all topics of the message type MsgT whose names match a
+    // regular expression and keeps only the latest message of each of them.
+    // New topics are looked up from the ROS master periodically in a separate
+    // thread, since the lookup blocks while the master is slow or unreachable;
+    // only the subscribers are created in the update() of the display.  The
+    // messages are processed by the display in its update() by iterating over
+    // the sources ordered by the topic names.  Errors are reported in the
+    // status of the display.
+    template <typename MsgT, typename SourceT>
+    class TopicSources
+    {
+      static_assert(std::is_base_of<TopicSource<MsgT>, SourceT>::value, "SourceT has to derive from TopicSource<MsgT>");
+
+    public:
+      using map_t = std::map<std::string, SourceT>;
+
+      // Returns whether the message can be displayed, the invalid ones are dropped.
+      using validator_t = std::function<bool(const MsgT& msg, const std::string& topic)>;
+
+      // how often to look for new topics matching the pattern [s]
+      static constexpr float refresh_period = 2.0f;
+
+      TopicSources(rviz::Display* display, ros::NodeHandle& nh, const validator_t& validator)
+          : display_(display), nh_(nh), validator_(validator), topic_regex_("$^"), refresh_timer_(0.0f)
+      {
+      }
+
+      TopicSources(const TopicSources&) = delete;
+      TopicSources& operator=(const TopicSources&) = delete;
+
+      // a pending lookup of the topics is waited for by the destructor of its future
+      ~TopicSources()
+      {
+        unsubscribe();
+      }
+
+      // Forgets all topics and subscribes to the ones matching the new
+      // pattern.  An invalid regular expression matches no topic.
+      void setPattern(const std::string& pattern)
+      {
+        try
+        {
+          topic_regex_ = std::regex(pattern);
+          display_->deleteStatus("Topic pattern");
+        }
+        catch (const std::regex_error& e)
+        {
+          display_->setStatus(rviz::StatusProperty::Error, "Topic pattern", QString("Invalid regular expression: ") + e.what());
+          topic_regex_ = std::regex("$^");
+        }
+
+        clear();
+        subscribe();
+      }
+
+      // Unsubscribes from and forgets all topics.
+      void clear()
+      {
+        unsubscribe();
+        sources_.clear();
+      }
+
+      // Starts looking up the matching topics if the display is enabled, they
+      // are subscribed by a later update().
+      void subscribe()
+      {
+        if (display_->isEnabled())
+          discover();
+      }
+
+      void unsubscribe()
+      {
+        for (auto& kv : sources_)
+          kv.second.sub.shutdown();
+      }
+
+      // To be called from the update() of the display, subscribes to the
+      // topics found by a finished lookup and starts a new lookup once per
+      // refresh_period.  Returns whether any topic was added.
+      bool update(const float wall_dt)
+      {
+        if (!discovery_.valid())
+        {
+          refresh_timer_ += wall_dt;
+          if (refresh_timer_ >= refresh_period)
+            discover();
+          return false;
+        }
+        if (discovery_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+          return false;
+        return subscribeTopics(discovery_.get());
+      }
+
+      // Forgets the received messages, the topics stay subscribed.
+      void reset()
+      {
+        for (auto& kv : sources_)
+        {
+          kv.second.msg = nullptr;
+          kv.second.new_msg = false;
+          kv.second.valid = false;
+        }
+      }
+
+      // Marks the latest messages as new, e.g. when the fixed frame changes
+      // and their transforms have to be looked up again.
+      void reprocess()
+      {
+        for (auto& kv : sources_)
+          kv.second.new_msg = kv.second.msg != nullptr;
+      }
+
+      size_t size() const
+      {
+        return sources_.size();
+      }
+
+      typename map_t::iterator begin()
+      {
+        return sources_.begin();
+      }
+
+      typename map_t::iterator end()
+      {
+        return sources_.end();
+      }
+
+      typename map_t::const_iterator begin() const
+      {
+        return sources_.begin();
+      }
+
+      typename map_t::const_iterator end() const
+      {
+        return sources_.end();
+      }
+
+    private:
+      struct discovery_t
+      {
+        bool ok = false;
+        ros::master::V_TopicInfo topics;
+      };
+
+      void discover()
+      {
+        refresh_timer_ = 0.0f;
+        if (discovery_.valid())
+          return;
+        discovery_ = std::async(std::launch::async, []() {
+          discovery_t ret;
+          ret.ok = ros::master::getTopics(ret.topics);
+          return ret;
+        });
+      }
+
+      bool subscribeTopics(const discovery_t& discovery)
+      {
+        if (!discovery.ok)
+        {
+          display_->setStatus(rviz::StatusProperty::Warn, "Topics", "Could not get the list of topics from the ROS master.");
+          return false;
+        }
+        if (!display_->isEnabled())
+          return false;
+
+        bool added = false;
+        const std::string datatype = ros::message_traits::datatype<MsgT>();
+        for (const auto& topic : discovery.topics)
+        {
+          if (topic.datatype != datatype || !std::regex_match(topic.name, topic_regex_))
+            continue;
+
+          auto& source = sources_[topic.name];
+          if (source.sub)
+            continue;
+
+          try
+          {
+            source.sub = nh_.subscribe<MsgT>(topic.name, 1, boost::bind(&TopicSources::callback, this, _1, topic.name));
+          }
+          catch (const ros::Exception& e)
+          {
+            display_->setStatus(rviz::StatusProperty::Error, "Topics", QString("Error subscribing to ") + topic.name.c_str() + ": " + e.what());
+            return added;
+          }
+          added = true;
+        }
+
+        display_->setStatus(rviz::StatusProperty::Ok, "Topics", QString::number(sources_.size()) + " topics subscribed");
+        return added;
+      }
+
+      void callback(const typename MsgT::ConstPtr& msg, const std::string& topic)
+      {
+        if (!validator_(*msg, topic))
+          return;
+
+        // only the newest message of each topic is kept, it is processed in the next update() of the display
+        auto& source = sources_[topic];
+        source.msg = msg;
+        source.new_msg = true;
+      }
+
+      rviz::Display* display_;
+      ros::NodeHandle& nh_;
+      validator_t validator_;
+      map_t sources_;
+      std::regex topic_regex_;
+      float refresh_timer_;
+      std::future<discovery_t> discovery_;
+    };
+
+  }  // namespace multi_display
+
+}  // end namespace mrs_rviz_plugins
+
+#endif  // MRS_MULTI_DISPLAY_TOPIC_SOURCES_H
@@ -3,15 +3,23 @@
 
 #include <boost/shared_ptr.hpp>
 
-#include <mrs_msgs/PoseWithCovarianceArrayStamped.h>
 
 #include <rviz/message_filter_display.h>
 #include <rviz/selection/forwards.h>
 
 #include <covariance/property.h>
+#include <covariance/shape_cache.h>
 #include <covariance/visual.h>
 
-#include <fast_arrow/fast_arrow.h>
+#include <fast_arrow/fast_arrow_batch.h>
+
+#include <pose_with_covariance_array/flat_message.h>
+#include <pose_with_covariance_array/prepared_poses.h>
+#include <pose_with_covariance_array/downsampling.h>
+#include <pose_with_covariance_array/pose_history.h>
+
+#include <selection/paged_properties.h>
+#include <selection/aabb_tree.h>
 
 namespace rviz
 {
@@ -20,6 +28,7 @@ class Axes;
 class ColorProperty;
 class EnumProperty;
 class FloatProperty;
+class IntProperty;
 class BoolProperty;
 class Shape;
 }  // namespace rviz
@@ -34,13 +43,11 @@ struct display_object
 {
   boost::shared_ptr<rviz::Arrow> arrow_;
   boost::shared_ptr<rviz::Axes> axes_;
-  boost::shared_ptr<rviz::FastArrow> fast_arrow_;
-  boost::shared_ptr<mrs_rviz_plugins::covariance::Visual> covariance_;
 };
 
 class DisplaySelectionHandler;
 
-class Display : public rviz::MessageFilterDisplay<mrs_msgs::PoseWithCovarianceArrayStamped> {
+class Display : public rviz::MessageFilterDisplay<FlatPoseWithCovarianceArrayStamped> {
   Q_OBJECT
 public:
   enum Shape
@@ -48,6 +55,7 @@ public:
     Arrow,
     Axes,
     FastArrow,
+    Glyphs,
   };
 
   Display();
@@ -56,6 +64,9 @@ public:
   virtual void onInitialize();
   virtual void reset();
 
+  /** @brief Overridden to cull the covariances against the camera every frame. */
+  virtual void update(float wall_dt, float ros_dt);
+
 protected:
   /** @brief Overridden from MessageFilterDisplay to get Arrow/Axes visibility correct. */
   virtual void onEnable();
@@ -66,14 +77,27 @@ private Q_SLOTS:
   void updateShapeChoice();
   void updateAxisGeometry();
   void updateArrowGeometry();
+  void updateSelectionPage();
+  void updateDownsampling();
+  void updateAccumulation();
 
 private:
   void clear();
 
-  virtual void processMessage(const mrs_msgs::PoseWithCovarianceArrayStamped::ConstPtr& message);
+  virtual void processMessage(const FlatPoseWithCovarianceArrayStamped::ConstPtr& message);
 
   std::vector<display_object> disp_data;
 
+  // the poses of the last message validated and transformed to the fixed frame
+  PreparedPoses prepared_;
+
+  // the indices of the prepared poses left after downsampling, they are the ones shown
+  Downsampling        downsampling_;
+  std::vector<size_t> selected_;
+
+  // the poses of the past messages shown in the accumulate mode, drawn by the fast arrows
+  PoseHistory history_;
+
   bool                       pose_valid_;
   std::unique_ptr<DisplaySelectionHandler> coll_handler_;
 
@@ -92,6 +116,21 @@ private:
 
   std::unique_ptr<covariance::Property> covariance_property_;
 
+  std::unique_ptr<rviz::EnumProperty>  downsampling_property_;
+  std::unique_ptr<rviz::FloatProperty> voxel_size_property_;
+  std::unique_ptr<rviz::IntProperty>   step_property_;
+  std::unique_ptr<rviz::IntProperty>   max_count_property_;
+
+  std::unique_ptr<rviz::BoolProperty> accumulate_property_;
+  std::unique_ptr<rviz::IntProperty>  history_size_property_;
+
+  // all the fast arrows of a message are drawn at once, the glyphs are fast arrows without heads
+  boost::shared_ptr<rviz::FastArrowBatch> fast_arrows_;
+
+  covariance::ShapeCache covariance_cache_;
+  // all the covariances of a message are drawn at once
+  covariance::Property::BatchVisualPtr covariance_batch_;
+
   friend class DisplaySelectionHandler;
 };
 
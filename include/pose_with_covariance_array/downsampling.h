@@ -0,0 +1,68 @@
+#ifndef POSE_WITH_COVARIANCE_ARRAY_DOWNSAMPLING_H
+#define POSE_WITH_COVARIANCE_ARRAY_DOWNSAMPLING_H
+
+#include <OgreVector3.h>
+
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+namespace mrs_rviz_plugins
+{
+
+namespace pose_with_covariance_array
+{
+
+/**
+ * \class Downsampling
+ * \brief Chooses a representative subset of the poses of a message to be shown
+ *
+ * Runs on the prepared poses before any visual is created, so the cost of the display stays
+ * bounded whatever the size of the messages. All the methods are deterministic, the same
+ * message always results in the same subset.
+ */
+class Downsampling {
+public:
+  enum Method
+  {
+    None,
+    VoxelGrid,  ///< The first pose of every voxel of the grid
+    EveryNth,   ///< Every n-th pose of the message
+    MaxCount,   ///< At most max_count poses chosen by a hash of their index
+  };
+
+  Downsampling();
+
+  void setMethod(Method method);
+  void setVoxelSize(double voxel_size);
+  void setStep(size_t step);
+  void setMaxCount(size_t max_count);
+
+  /**
+   * \brief Choose the poses to be shown
+   *
+   * @param positions Positions of the poses in the fixed frame
+   * @param n_poses Number of the poses to choose from, the first ones of \p positions
+   * @param indices The indices of the chosen poses in ascending order
+   */
+  void select(const std::vector<Ogre::Vector3>& positions, size_t n_poses, std::vector<size_t>& indices);
+
+private:
+  void selectVoxelGrid(const std::vector<Ogre::Vector3>& positions, size_t n_poses, std::vector<size_t>& indices);
+  void selectMaxCount(size_t n_poses, std::vector<size_t>& indices);
+
+  Method method_;
+  double voxel_size_;
+  size_t step_;
+  size_t max_count_;
+
+  // kept between messages to reuse their memory
+  std::unordered_set<uint64_t>                voxels_;
+  std::vector<std::pair<uint64_t, size_t>> hashes_;
+};
+
+}  // namespace pose_with_covariance_array
+
+}  // namespace mrs_rviz_plugins
+
+#endif /* POSE_WITH_COVARIANCE_ARRAY_DOWNSAMPLING_H */
@@ -0,0 +1,188 @@
+#ifndef POSE_WITH_COVARIANCE_ARRAY_FLAT_MESSAGE_H
+#define POSE_WITH_COVARIANCE_ARRAY_FLAT_MESSAGE_H
+
+#include <mrs_msgs/PoseWithCovarianceArrayStamped.h>
+
+#include <ros/message_traits.h>
+#include <ros/serialization.h>
+#include <std_msgs/Header.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <cstring>
+#include <vector>
+
+namespace mrs_rviz_plugins
+{
+
+namespace pose_with_covariance_array
+{
+
+/**
+ * \struct FlatPoseWithCovarianceArrayStamped
+ * \brief mrs_msgs::PoseWithCovarianceArrayStamped decoded into flat arrays
+ *
+ * It has the data type and MD5 sum of the original message, so it subscribes to the same topics,
+ * but its serializer decodes the poses straight into one array per field instead of a vector of
+ * nested structs, which the display would only copy again into its own buffers.
+ */
+struct FlatPoseWithCovarianceArrayStamped
+{
+  typedef boost::shared_ptr<FlatPoseWithCovarianceArrayStamped>       Ptr;
+  typedef boost::shared_ptr<const FlatPoseWithCovarianceArrayStamped> ConstPtr;
+  typedef mrs_msgs::PoseWithCovarianceIdentified::_id_type            Id;
+
+  std_msgs::Header    header;
+  std::vector<Id>     ids;
+  std::vector<double> positions;     ///< x, y, z of each pose
+  std::vector<double> orientations;  ///< x, y, z, w of each pose, the order of geometry_msgs::Quaternion
+  std::vector<double> covariances;   ///< the 36 elements of the row-major covariance of each pose
+
+  size_t size() const {
+    return ids.size();
+  }
+
+  void resize(size_t size) {
+    ids.resize(size);
+    positions.resize(3 * size);
+    orientations.resize(4 * size);
+    covariances.resize(36 * size);
+  }
+
+  const double* position(size_t index) const {
+    return &positions[3 * index];
+  }
+
+  const double* orientation(size_t index) const {
+    return &orientations[4 * index];
+  }
+
+  const double* covariance(size_t index) const {
+    return &covariances[36 * index];
+  }
+};
+
+}  // namespace pose_with_covariance_array
+
+}  // namespace mrs_rviz_plugins
+
+namespace ros
+{
+
+namespace message_traits
+{
+
+// Same as mrs_msgs::PoseWithCovarianceArrayStamped, the publishers see no difference
+
+template <>
+struct IsMessage<mrs_rviz_plugins::pose_with_covariance_array::FlatPoseWithCovarianceArrayStamped> : TrueType
+{
+};
+
+template <>
+struct IsMessage<const mrs_rviz_plugins::pose_with_covariance_array::FlatPoseWithCovarianceArrayStamped> : TrueType
+{
+};
+
+template <>
+struct HasHeader<mrs_rviz_plugins::pose_with_covariance_array::FlatPoseWithCovarianceArrayStamped> : TrueType
+{
+};
+
+template <>
+struct HasHeader<const mrs_rviz_plugins::pose_with_covariance_array::FlatPoseWithCovarianceArrayStamped> : TrueType
+{
+};
+
+template <>
+struct MD5Sum<mrs_rviz_plugins::pose_with_covariance_array::FlatPoseWithCovarianceArrayStamped>
+{
+  static const char* value() {
+    return MD5Sum<mrs_msgs::PoseWithCovarianceArrayStamped>::value();
+  }
+
+  static const char* value(const mrs_rviz_plugins::pose_with_covariance_array::FlatPoseWithCovarianceArrayStamped&) {
+    return value();
+  }
+};
+
+template <>
+struct DataType<mrs_rviz_plugins::pose_with_covariance_array::FlatPoseWithCovarianceArrayStamped>
+{
+  static const char* value() {
+    return DataType<mrs_msgs::PoseWithCovarianceArrayStamped>::value();
+  }
+
+  static const char* value(const mrs_rviz_plugins::pose_with_covariance_array::FlatPoseWithCovarianceArrayStamped&) {
+    return value();
+  }
+};
+
+template <>
+struct Definition<mrs_rviz_plugins::pose_with_covariance_array::FlatPoseWithCovarianceArrayStamped>
+{
+  static const char* value() {
+    return Definition<mrs_msgs::PoseWithCovarianceArrayStamped>::value();
+  }
+
+  static const char* value(const mrs_rviz_plugins::pose_with_covariance_array::FlatPoseWithCovarianceArrayStamped&) {
+    return value();
+  }
+};
+
+}  // namespace message_traits
+
+namespace serialization
+{
+
+/*
+ * The wire format of mrs_msgs::PoseWithCovarianceArrayStamped: the header, the number of the poses and then
+ * the id, position, orientation and covariance of each pose, in the order of mrs_msgs::PoseWithCovarianceIdentified.
+ */
+template <>
+struct Serializer<mrs_rviz_plugins::pose_with_covariance_array::FlatPoseWithCovarianceArrayStamped>
+{
+  typedef mrs_rviz_plugins::pose_with_covariance_array::FlatPoseWithCovarianceArrayStamped Message;
+
+  static constexpr uint32_t pose_length = sizeof(Message::Id) + (3 + 4 + 36) * sizeof(double);
+
+  template <typename Stream>
+  inline static void write(Stream& stream, const Message& m) {
+    stream.next(m.header);
+    stream.next(static_cast<uint32_t>(m.size()));
+    for (size_t it = 0; it < m.size(); it++) {
+      stream.next(m.ids[it]);
+      memcpy(stream.advance(3 * sizeof(double)), m.position(it), 3 * sizeof(double));
+      memcpy(stream.advance(4 * sizeof(double)), m.orientation(it), 4 * sizeof(double));
+      memcpy(stream.advance(36 * sizeof(double)), m.covariance(it), 36 * sizeof(double));
+    }
+  }
+
+  template <typename Stream>
+  inline static void read(Stream& stream, Message& m) {
+    stream.next(m.header);
+    uint32_t size;
+    stream.next(size);
+    // checks the length of the whole array at once, the fields are then copied straight from the buffer
+    if (static_cast<uint64_t>(size) * pose_length > stream.getLength())
+      throw StreamOverrunException("Buffer overrun while deserializing the poses of mrs_msgs/PoseWithCovarianceArrayStamped");
+    const uint8_t* data = stream.advance(size * pose_length);
+    m.resize(size);
+    for (size_t it = 0; it < size; it++, data += pose_length) {
+      memcpy(&m.ids[it], data, sizeof(Message::Id));
+      memcpy(&m.positions[3 * it], data + sizeof(Message::Id), 3 * sizeof(double));
+      memcpy(&m.orientations[4 * it], data + sizeof(Message::Id) + 3 * sizeof(double), 4 * sizeof(double));
+      memcpy(&m.covariances[36 * it], data + sizeof(Message::Id) + 7 * sizeof(double), 36 * sizeof(double));
+    }
+  }
+
+  inline static uint32_t serializedLength(const Message& m) {
+    return serializationLength(m.header) + 4 + m.size() * pose_length;
+  }
+};
+
+}  // namespace serialization
+
+}  // namespace ros
+
+#endif /* POSE_WITH_COVARIANCE_ARRAY_FLAT_MESSAGE_H */
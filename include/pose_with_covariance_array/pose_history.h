@@ -0,0 +1,58 @@
+#ifndef POSE_WITH_COVARIANCE_ARRAY_POSE_HISTORY_H
+#define POSE_WITH_COVARIANCE_ARRAY_POSE_HISTORY_H
+
+#include <cstddef>
+
+namespace mrs_rviz_plugins
+{
+
+namespace pose_with_covariance_array
+{
+
+/**
+ * \class PoseHistory
+ * \brief Slots of the ring buffer of the poses of the past messages
+ *
+ * The poses themselves are only kept by the batch drawing the history, this assigns them its
+ * arrows. When the history is full, each new pose takes the slot of the oldest one, so the slot
+ * is the index of the arrow that has to be rewritten in the batch.
+ */
+class PoseHistory {
+public:
+  explicit PoseHistory(size_t capacity = 0);
+
+  /**
+   * \brief Change the capacity, the history is cleared if it differs from the current one
+   */
+  void setCapacity(size_t capacity);
+
+  size_t capacity() const {
+    return capacity_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  void clear();
+
+  /**
+   * \brief Append a pose, replacing the oldest one if the history is full
+   *
+   * The capacity must not be zero.
+   *
+   * @return The slot of the new pose
+   */
+  size_t push();
+
+private:
+  size_t capacity_;
+  size_t next_;  ///< The slot taken by the next push()
+  size_t size_;
+};
+
+}  // namespace pose_with_covariance_array
+
+}  // namespace mrs_rviz_plugins
+
+#endif /* POSE_WITH_COVARIANCE_ARRAY_POSE_HISTORY_H */
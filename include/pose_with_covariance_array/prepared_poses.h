@@ -0,0 +1,89 @@
+#ifndef POSE_WITH_COVARIANCE_ARRAY_PREPARED_POSES_H
+#define POSE_WITH_COVARIANCE_ARRAY_PREPARED_POSES_H
+
+#include <pose_with_covariance_array/flat_message.h>
+#include <pose_with_covariance_array/worker_pool.h>
+
+#include <OgreVector3.h>
+#include <OgreQuaternion.h>
+
+#include <vector>
+
+namespace mrs_rviz_plugins
+{
+
+namespace pose_with_covariance_array
+{
+
+/**
+ * \class PreparedPoses
+ * \brief The poses of a message validated and transformed to the fixed frame
+ *
+ * The first phase of processing a message. It does not touch any Ogre object, so the poses of
+ * large messages are split into chunks prepared in parallel and the display then only applies
+ * the results to its visuals. The buffers and the threads are kept between messages.
+ */
+class PreparedPoses {
+public:
+  /**
+   * \brief Validate and transform the poses of a message
+   *
+   * @param message The message to prepare
+   * @param frame_position, frame_orientation The transform from the frame of the message to the fixed frame
+   * @param max_threads Upper bound on the number of threads including the calling one, 0 means the number of hardware threads
+   */
+  void prepare(const FlatPoseWithCovarianceArrayStamped& message, const Ogre::Vector3& frame_position,
+               const Ogre::Quaternion& frame_orientation, unsigned max_threads = 0);
+
+  /**
+   * \brief Number of the poses before the first one with invalid floating point values, the following ones are not shown
+   */
+  size_t getValidCount() const {
+    return n_valid_;
+  }
+
+  /**
+   * \brief Whether some of the valid poses have unnormalized quaternions
+   */
+  bool hasUnnormalized() const {
+    return unnormalized_;
+  }
+
+  /// Positions in the fixed frame
+  const std::vector<Ogre::Vector3>& getPositions() const {
+    return positions_;
+  }
+
+  /// Normalized orientations in the fixed frame
+  const std::vector<Ogre::Quaternion>& getOrientations() const {
+    return orientations_;
+  }
+
+private:
+  struct ChunkResult
+  {
+    size_t first_invalid;
+    size_t first_unnormalized;
+  };
+
+  ChunkResult prepareRange(const FlatPoseWithCovarianceArrayStamped& message, const Ogre::Vector3& frame_position,
+                           const Ogre::Quaternion& frame_orientation, size_t first, size_t last);
+
+  // Below this number of poses per chunk, prepare() does not split a message further. A pose is
+  // prepared in tens of nanoseconds, while handing a chunk to a worker and waiting for it takes
+  // microseconds, so only chunks of about this size make up for it.
+  static constexpr size_t min_poses_per_thread = 1024;
+
+  WorkerPool pool_;
+
+  std::vector<Ogre::Vector3>    positions_;
+  std::vector<Ogre::Quaternion> orientations_;
+  size_t                        n_valid_      = 0;
+  bool                          unnormalized_ = false;
+};
+
+}  // namespace pose_with_covariance_array
+
+}  // namespace mrs_rviz_plugins
+
+#endif /* POSE_WITH_COVARIANCE_ARRAY_PREPARED_POSES_H */
@@ -0,0 +1,60 @@
+#ifndef POSE_WITH_COVARIANCE_ARRAY_WORKER_POOL_H
+#define POSE_WITH_COVARIANCE_ARRAY_WORKER_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mrs_rviz_plugins
+{
+
+namespace pose_with_covariance_array
+{
+
+/**
+ * \class WorkerPool
+ * \brief Threads kept between messages to run the chunks of a message in parallel
+ *
+ * The threads are started once the first message needs them and wait for the next one
+ * afterwards, so a display receiving messages at a high rate does not create threads for each.
+ */
+class WorkerPool {
+public:
+  WorkerPool() = default;
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  /**
+   * \brief Call task with each index in [0, n_tasks) and wait until all calls returned
+   *
+   * The calling thread takes part in the work, so n_tasks - 1 threads are used at most.
+   */
+  void run(size_t n_tasks, const std::function<void(size_t)>& task);
+
+private:
+  void work();
+
+  // takes the next index and runs its task, the lock is released meanwhile; false if all are taken
+  bool runNext(std::unique_lock<std::mutex>& lock);
+
+  std::vector<std::thread> threads_;
+
+  std::mutex                         mutex_;
+  std::condition_variable            task_added_;
+  std::condition_variable            task_done_;
+  const std::function<void(size_t)>* task_      = nullptr;
+  size_t                             n_tasks_   = 0;
+  size_t                             next_      = 0;
+  size_t                             n_running_ = 0;
+  bool                               stop_      = false;
+};
+
+}  // namespace pose_with_covariance_array
+
+}  // namespace mrs_rviz_plugins
+
+#endif /* POSE_WITH_COVARIANCE_ARRAY_WORKER_POOL_H */
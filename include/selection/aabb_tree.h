@@ -0,0 +1,65 @@
+#ifndef SELECTION_AABB_TREE_H
+#define SELECTION_AABB_TREE_H
+
+#include <OgreAxisAlignedBox.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace mrs_rviz_plugins
+{
+
+namespace selection
+{
+
+/**
+ * \class AabbTree
+ * \brief Bounding volume hierarchy over the bounding boxes of the elements of an array
+ *
+ * Built once per message, it lets the selection handlers highlight an array of thousands
+ * of elements by a bounded number of boxes, each of them enclosing a group of nearby
+ * elements, instead of computing and drawing the boxes of all their shapes every frame.
+ */
+class AabbTree {
+public:
+  /**
+   * \brief Build the hierarchy, null boxes are left out
+   */
+  void build(const std::vector<Ogre::AxisAlignedBox>& boxes);
+
+  void clear();
+
+  bool empty() const {
+    return nodes_.empty();
+  }
+
+  /**
+   * \brief Append the boxes of the deepest level of the hierarchy with at most max_boxes nodes
+   *
+   * A single box encloses all the elements, as many boxes as elements enclose them one by one.
+   */
+  void collectBoxes(size_t max_boxes, std::vector<Ogre::AxisAlignedBox>& boxes) const;
+
+private:
+  struct Node
+  {
+    Ogre::AxisAlignedBox box;
+    uint32_t             left;   ///< Index of the first child, the second one follows it, 0 for leaves
+    uint32_t             first;  ///< First element of a leaf in elements_
+    uint32_t             count;  ///< Number of elements of a leaf
+  };
+
+  void buildNode(uint32_t index, uint32_t first, uint32_t last);
+
+  static constexpr uint32_t max_leaf_size = 4;
+
+  std::vector<Node>                 nodes_;
+  std::vector<Ogre::AxisAlignedBox> boxes_;
+  std::vector<uint32_t>             elements_;
+};
+
+}  // namespace selection
+
+}  // namespace mrs_rviz_plugins
+
+#endif /* SELECTION_AABB_TREE_H */
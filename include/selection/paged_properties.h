@@ -0,0 +1,72 @@
+#ifndef SELECTION_PAGED_PROPERTIES_H
+#define SELECTION_PAGED_PROPERTIES_H
+
+#include <functional>
+#include <vector>
+
+class QObject;
+
+namespace rviz
+{
+class IntProperty;
+class Property;
+}  // namespace rviz
+
+namespace mrs_rviz_plugins
+{
+
+namespace selection
+{
+
+/**
+ * \class PagedProperties
+ * \brief Shows the elements of a large array in the selection panel one page at a time
+ *
+ * Creating the properties of all the elements of an array of thousands of poses freezes rviz,
+ * so only the rows of the current page exist. The page is chosen by an integer property, the
+ * rows of the previous page are destroyed and the ones of the new page created when it changes.
+ */
+class PagedProperties {
+public:
+  /**
+   * \brief Creates the property of the element with the given index under the parent and returns it
+   */
+  typedef std::function<rviz::Property*(size_t index, rviz::Property* parent)> RowFactory;
+
+  static constexpr size_t page_size = 50;
+
+  PagedProperties();
+
+  /**
+   * \brief Create the page property and the rows of the first page
+   *
+   * @param parent The property the page property and the rows are added to
+   * @param n_elements Number of elements of the array
+   * @param receiver, changed_slot Notified when the page changes, the slot has to call updatePage()
+   * @param factory Creates the properties of a single element
+   */
+  void create(rviz::Property* parent, size_t n_elements, QObject* receiver, const char* changed_slot, const RowFactory& factory);
+
+  /**
+   * \brief Replace the rows by the ones of the current page
+   */
+  void updatePage();
+
+  /**
+   * \brief Forget the properties, to be called when the parent property is destroyed
+   */
+  void reset();
+
+private:
+  rviz::Property*              parent_;
+  rviz::IntProperty*           page_property_;
+  std::vector<rviz::Property*> rows_;
+  size_t                       n_elements_;
+  RowFactory                   factory_;
+};
+
+}  // namespace selection
+
+}  // namespace mrs_rviz_plugins
+
+#endif /* SELECTION_PAGED_PROPERTIES_H */
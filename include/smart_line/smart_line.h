@@ -3,14 +3,27 @@
  
 #include <rviz/ogre_helpers/line.h>
 
+#include <OgreMaterial.h>
+
  namespace rviz
  {
  class SmartLine : public Line
  {
  public:
    using Line::Line; //inherited constructor
+   ~SmartLine() override;
+
+   // Lines of the same unshaded color share one material, see setColorUnshaded()
    void setColorUnshaded(const Ogre::ColourValue& c);
+   void setColor(float r, float g, float b, float a) override;
+
+ private:
+   void useMaterial(const Ogre::MaterialPtr& material);
+   void releaseSharedMaterial();
 
+   Ogre::MaterialPtr own_material_;     // the material created by Line, restored before Line destroys it
+   Ogre::MaterialPtr shared_material_;  // the unshaded material taken from the cache, if any
+   Ogre::RGBA shared_key_ = 0;
  };
  
  } // namespace rviz
@@ -0,0 +1,135 @@
+// clang: MatousFormat
+
+#ifndef MRS_SPHERE_MULTI_DISPLAY_H
+#define MRS_SPHERE_MULTI_DISPLAY_H
+
+#ifndef Q_MOC_RUN
+#include <ros/ros.h>
+
+#include <rviz/display.h>
+#include <mrs_msgs/Sphere.h>
+
+#include <OGRE/OgreCamera.h>
+#include <OGRE/OgreMaterial.h>
+#include <OGRE/OgreVector3.h>
+#include <OGRE/OgreQuaternion.h>
+#include <OGRE/OgreColourValue.h>
+
+#include <multi_display/topic_sources.h>
+#include <sphere/unit_circle.h>
+#endif
+
+#include <string>
+
+namespace Ogre
+{
+  class ManualObject;
+}
+
+namespace rviz
+{
+  class BoolProperty;
+  class ColorProperty;
+  class FloatProperty;
+  class StringProperty;
+}  // namespace rviz
+
+namespace mrs_rviz_plugins
+{
+
+  namespace sphere
+  {
+
+    // Displays the spheres from several mrs_msgs/Sphere topics at once.  It
+    // subscribes to all topics matching a regular expression and draws the
+    // circles of all spheres into a single vertex-colored line list.  A single
+    // camera listener orients the dynamic circles towards the viewer and
+    // selects the level of detail of each sphere from its size on the screen;
+    // the line list is only rebuilt when the camera or one of the spheres moves.
+    class MultiDisplay : public rviz::Display
+    {
+      Q_OBJECT
+    public:
+      using msg_t = mrs_msgs::Sphere;
+
+      MultiDisplay();
+      virtual ~MultiDisplay();
+
+    protected:
+      virtual void onInitialize();
+      virtual void onEnable();
+      virtual void onDisable();
+      virtual void fixedFrameChanged();
+
+      // Called once per render frame, looks up the frames of new messages.
+      virtual void update(float wall_dt, float ros_dt);
+
+      // A helper to clear this display back to the initial state.
+      virtual void reset();
+
+    private Q_SLOTS:
+      void updateTopicPattern();
+      void updateAppearance();
+      void onViewControllerChanged();
+
+    private:
+      struct source_t : multi_display::TopicSource<msg_t>
+      {
+        // the sphere in the fixed frame
+        Ogre::Vector3 center;
+        Ogre::Quaternion orientation;
+        float radius = 0.0f;
+        // index to lod_segments, kept between the redraws for the hysteresis
+        int lod = default_lod;
+      };
+
+      static bool isValid(const msg_t& msg, const std::string& topic);
+      Ogre::ColourValue sourceColor(const size_t source_idx) const;
+
+      // Called from the camera listener, rebuilds the line list if the camera or the spheres changed.
+      void redraw(const Ogre::Camera* cam);
+
+      multi_display::TopicSources<msg_t, source_t> sources_;
+      bool dirty_;
+
+      // pose of the camera the line list was last built for
+      Ogre::Vector3 drawn_cam_position_;
+      Ogre::Quaternion drawn_cam_orientation_;
+
+      Ogre::ManualObject* manual_object_;
+      Ogre::MaterialPtr material_;
+      Ogre::Camera* camera_;
+
+      // User-editable property variables.
+      rviz::StringProperty* topic_pattern_property_;
+      rviz::ColorProperty* color_property_;
+      rviz::BoolProperty* unique_colors_property_;
+      rviz::FloatProperty* alpha_property_;
+      rviz::BoolProperty* draw_dynamic_property_;
+      rviz::BoolProperty* draw_static_property_;
+      rviz::BoolProperty* dashed_dynamic_property_;
+      rviz::BoolProperty* dashed_static_property_;
+
+      class CameraListener : public Ogre::Camera::Listener
+      {
+        MultiDisplay* disp_;
+
+      public:
+        CameraListener(MultiDisplay* disp) : disp_(disp)
+        {
+        }
+
+        void cameraPreRenderScene(Ogre::Camera* cam)
+        {
+          disp_->redraw(cam);
+        }
+      };
+
+      CameraListener cam_listener_;
+    };
+
+  }  // namespace sphere
+
+}  // end namespace mrs_rviz_plugins
+
+#endif  // MRS_SPHERE_MULTI_DISPLAY_H
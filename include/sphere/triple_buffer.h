@@ -0,0 +1,67 @@
+// clang: MatousFormat
+
+#ifndef SPHERE_TRIPLE_BUFFER_H
+#define SPHERE_TRIPLE_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace mrs_rviz_plugins
+{
+
+  namespace sphere
+  {
+
+    // A lock-free triple buffer passing snapshots of a value from a single
+    // producer to a single consumer.  The producer always has a buffer to
+    // write to and the consumer always has a complete buffer to read from,
+    // so neither of them ever waits for the other.  Intermediate values
+    // written faster than the consumer reads them are dropped.
+    template <typename T>
+    class TripleBuffer
+    {
+    public:
+      // Called by the producer only.  Copies the value to the back buffer
+      // and publishes it by swapping it with the middle buffer.
+      void write(const T& value)
+      {
+        m_buffers[m_back] = value;
+        const uint8_t prev = m_middle.exchange(m_back | dirty_flag, std::memory_order_acq_rel);
+        m_back = prev & index_mask;
+      }
+
+      // Called by the consumer only.  Swaps the front buffer with the middle
+      // one if a new value was published since the last call.  Returns
+      // whether front() has changed.
+      bool update()
+      {
+        if (!(m_middle.load(std::memory_order_acquire) & dirty_flag))
+          return false;
+        // only the consumer clears the flag, so the middle buffer is still the new one
+        const uint8_t prev = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = prev & index_mask;
+        return true;
+      }
+
+      // Called by the consumer only.  The latest value obtained by update().
+      const T& front() const
+      {
+        return m_buffers[m_front];
+      }
+
+    private:
+      static constexpr uint8_t index_mask = 0x3;
+      static constexpr uint8_t dirty_flag = 0x4;
+
+      std::array<T, 3> m_buffers = {};
+      uint8_t m_back = 0;                  // owned by the producer
+      std::atomic<uint8_t> m_middle{1};    // index of the shared buffer and the dirty flag
+      uint8_t m_front = 2;                 // owned by the consumer
+    };
+
+  }  // namespace sphere
+
+}  // end namespace mrs_rviz_plugins
+
+#endif // SPHERE_TRIPLE_BUFFER_H
@@ -0,0 +1,42 @@
+// clang: MatousFormat
+
+#ifndef SPHERE_UNIT_CIRCLE_H
+#define SPHERE_UNIT_CIRCLE_H
+
+#include <OGRE/OgreVector2.h>
+
+#include <lod/screen_size.h>
+
+#include <array>
+#include <vector>
+
+namespace mrs_rviz_plugins
+{
+
+  namespace sphere
+  {
+
+    // Number of segments of the unit circle for each level of detail, from the coarsest to the finest.
+    constexpr std::array<int, 5> lod_segments = {8, 16, 32, 64, 128};
+
+    // Level of detail used before the circle is first seen by a camera.
+    constexpr int default_lod = 2;
+
+    // A circle switches to a coarser level only once it would do so even if it
+    // was this many times larger, the same as the covariance meshes.
+    constexpr float lod_hysteresis = 1.5f;
+
+    // Returns the points of a unit circle in the XY plane for the given level of
+    // detail.  The points are computed only once and shared by all circles.
+    const std::vector<Ogre::Vector2>& unitCircle(const int lod);
+
+    // Returns the coarsest level of the unit circle which keeps the deviation of
+    // the drawn polygon from a circle with the given radius under half a pixel,
+    // the finer level `current` is kept within the lod_hysteresis.
+    int selectLod(const float screen_radius, const int current);
+
+  }  // namespace sphere
+
+}  // end namespace mrs_rviz_plugins
+
+#endif // SPHERE_UNIT_CIRCLE_H
@@ -14,7 +14,8 @@
 #include <rviz/view_manager.h>
 #include <rviz/view_controller.h>
 
-#include <mutex>
+#include <sphere/unit_circle.h>
+#include <sphere/triple_buffer.h>
 
 namespace Ogre
 {
@@ -67,31 +68,59 @@ Q_OBJECT
  private Q_SLOTS:
       void onViewControllerChanged();
 
-      void fillCircle(Ogre::ManualObject* circle, float x, float y, float z, float r, const Ogre::Quaternion& q, int n_pts = 32);
+    private:
+      // Everything needed to draw the sphere.  The setters only modify
+      // ``params_`` and publish its copy, the scene itself is only modified
+      // from the render thread in applyParams().
+      struct params_t
+      {
+        bool got_msg = false;
+
+        // values set in Rviz
+        bool draw_dynamic = true;
+        bool draw_static = true;
+        bool dashed_dynamic = false;
+        bool dashed_static = false;
+        float red = 1.0f, green = 1.0f, blue = 1.0f, alpha = 1.0f;
+
+        // values received from the message
+        double radius = 0.0;
+        Ogre::Vector3 position = Ogre::Vector3::ZERO;
+      };
 
-      Ogre::ManualObject* initCircle(const std::string& name, float x, float y, float z, float r, const Ogre::Quaternion& q, bool dashed, int n_pts = 32);
+      // Fills the circle with a unit circle in the XY plane centered at the origin.
+      // The position, radius and orientation of the circle are given by its scene node.
+      // The number of segments is given by the current level of detail ``lod_``.
+      void fillCircle(Ogre::ManualObject* circle, bool dashed);
+
+      Ogre::ManualObject* initCircle(const std::string& name, Ogre::SceneNode* node, bool dashed);
 
       void freeCircle(Ogre::ManualObject*& circle_ptr);
 
-    private:
-      bool got_msg_ = false;
+      // Publishes the current ``params_`` to the render thread.
+      void publishParams();
+
+      // Called from the render thread only.  Brings the circles up to date
+      // with the latest published parameters and the camera.
+      void applyParams(const Ogre::Camera* cam);
 
-      // values set in Rviz
-      bool draw_dynamic_ = true;
-      bool draw_static_ = true;
-      bool dashed_dynamic_ = false;
-      bool dashed_static_ = false;
-      float red_, green_, blue_, alpha_;
+      // written by the setters, only read by publishParams()
+      params_t params_;
+      // lock-free handover of the parameters to the render thread
+      TripleBuffer<params_t> params_buffer_;
+      // the parameters the circles are currently drawn with, owned by the render thread
+      params_t drawn_params_;
 
-      // values received from the message
-      double radius_;
-      Ogre::Vector3 position_;
+      // index to lod_segments, shared by all circles of the sphere as they have the same radius
+      int lod_ = default_lod;
 
-      std::mutex circles_quat_mtx_;
       std::array<Ogre::ManualObject*, 4> circles_ = {nullptr};
       std::array<std::string, 4> circle_names_ = {"circle_dyn" + std::to_string(sphere_idx), "circle_xy" + std::to_string(sphere_idx), "circle_yz" + std::to_string(sphere_idx), "circle_xz" + std::to_string(sphere_idx)};
       std::array<Ogre::Quaternion, 4> circle_quats_ = {};
+      // each circle has its own node which holds its position, orientation and radius (as scale)
+      std::array<Ogre::SceneNode*, 4> circle_nodes_ = {nullptr};
       Ogre::ManualObject*& circle_dyn_ = circles_[0];
+      Ogre::SceneNode*& circle_dyn_node_ = circle_nodes_[0];
 
       Ogre::Camera* camera_ = nullptr;
 
@@ -108,24 +137,19 @@ Q_OBJECT
       class CameraListener : public Ogre::Camera::Listener
       {
         Visual* vis_;
-        Ogre::ManualObject*& circle_;
 
         public:
         CameraListener(Visual* vis)
-          : vis_(vis), circle_(vis_->circle_dyn_)
+          : vis_(vis)
         {}
 
-        float last_x, last_y, last_cx, last_cy;
+        // All changes of the circles happen here, just before rendering.  The
+        // orientation of the dynamic circle's node is updated every frame, the
+        // geometry is only rebuilt when the parameters or the level of detail change.
         void cameraPreRenderScene(Ogre::Camera *cam)
         {
-          /* const Ogre::Vector3 eyeSpacePos = cam->getViewMatrix(true) * vis_->position_; */
-          /* const auto projMat = cam->getProjectionMatrix(); */
-          std::lock_guard<std::mutex> lck(vis_->circles_quat_mtx_);
-          Ogre::Quaternion& q = vis_->circle_quats_.at(0);
-          q = vis_->frame_node_->convertWorldToLocalOrientation(cam->getOrientation());
-          circle_->beginUpdate(0);
-          vis_->fillCircle(circle_, vis_->position_.x, vis_->position_.y, vis_->position_.z, vis_->radius_, q);
-          circle_->end();
+          vis_->applyParams(cam);
+          vis_->circle_dyn_node_->setOrientation(vis_->frame_node_->convertWorldToLocalOrientation(cam->getOrientation()));
         }
       };
 
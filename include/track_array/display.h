@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string> 
+#include <unordered_map>
 
 #include <ros/ros.h>
 
@@ -14,11 +15,18 @@
 
 #include <rviz/message_filter_display.h>
 #include <rviz/selection/forwards.h>
-#include <rviz/default_plugin/covariance_property.h>
-#include <rviz/default_plugin/covariance_visual.h>
 #include <rviz/ogre_helpers/movable_text.h>
 
+#include <covariance/property.h>
+#include <covariance/batch_visual.h>
+
+#include <frame_transform/frame_transform.h>
+
+#include <selection/paged_properties.h>
+#include <selection/aabb_tree.h>
+
 #include <OGRE/OgreEntity.h>
+#include <OGRE/OgreManualObject.h>
 #include <OGRE/OgreSceneNode.h>
 #include <OGRE/OgreSceneManager.h>
 #include <OGRE/OgreVector3.h>
@@ -42,6 +50,8 @@
 #include <rviz/validate_floats.h>
 #include <rviz/validate_quaternions.h>
 #include <rviz/selection/selection_handler.h>
+#include <rviz/view_controller.h>
+#include <rviz/view_manager.h>
 #include <rviz/msg_conversions.h>
 
 
@@ -64,14 +74,15 @@ namespace track_array
 
     struct display_object
     {
+        //parent of all the objects of the track, destroyed after them:
+        boost::shared_ptr<Ogre::SceneNode> node_;
+
         //position and orientation:
         boost::shared_ptr<rviz::Axes> axes_pose_;
-        boost::shared_ptr<rviz::CovarianceVisual> covariance_pose_;
 
         //velocity:
         boost::shared_ptr<rviz::Arrow> arrow_vel_;
         float arrow_vel_len_; //real length of velocity arrow without scaling
-        boost::shared_ptr<rviz::CovarianceVisual> covariance_vel_;
 
         //marker:
         boost::shared_ptr<TextID> text_id_;
@@ -87,6 +98,7 @@ namespace track_array
         virtual ~Display();
 
         virtual void onInitialize();
+        virtual void update(float wall_dt, float ros_dt);
         virtual void reset();
 
     protected:
@@ -109,12 +121,19 @@ namespace track_array
         void updateTextIDSize();
         void updateTextIDShift();
 
+        void updateSelectionPage();
+
     private:
         void clear();
 
         virtual void processMessage(const mrs_msgs::TrackArrayStamped::ConstPtr& message);
 
+        display_object acquireTrack();
+        void releaseTrack(display_object& d);
+
         std::vector<display_object> disp_data_; //all tracked objects
+        std::unordered_map<mrs_msgs::Track::_id_type, size_t> track_index_; //index of each track id in disp_data_
+        std::vector<display_object> track_pool_; //objects of the disappeared tracks, detached from the scene
 
         std::unique_ptr<DisplaySelectionHandler> coll_handler_;
 
@@ -129,14 +148,18 @@ namespace track_array
         std::unique_ptr<rviz::FloatProperty> velocity_arrow_head_radius_property_;
         std::unique_ptr<rviz::FloatProperty> velocity_arrow_head_length_property_;
 
-        std::unique_ptr<rviz::CovarianceProperty> velocity_covariance_property_;
+        std::unique_ptr<covariance::Property> velocity_covariance_property_;
         std::unique_ptr<rviz::FloatProperty> velocity_covariance_alpha_;
 
         std::unique_ptr<rviz::BoolProperty> axes_bool_property_;
         std::unique_ptr<rviz::FloatProperty> axes_length_property_;
         std::unique_ptr<rviz::FloatProperty> axes_radius_property_;
 
-        std::unique_ptr<rviz::CovarianceProperty> pose_covariance_property_;
+        std::unique_ptr<covariance::Property> pose_covariance_property_;
+
+        //the covariances of all the tracks, drawn in two meshes each:
+        covariance::Property::BatchVisualPtr covariance_pose_batch_;
+        covariance::Property::BatchVisualPtr covariance_vel_batch_;
 
         std::unique_ptr<rviz::BoolProperty> id_text_bool_property_;
         std::unique_ptr<rviz::ColorProperty> id_text_color_property_;
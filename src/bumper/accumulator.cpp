@@ -0,0 +1,206 @@
+// clang: MatousFormat
+
+#include <OGRE/OgreVector3.h>
+#include <OGRE/OgreQuaternion.h>
+#include <OGRE/OgreSceneNode.h>
+#include <OGRE/OgreSceneManager.h>
+#include <OGRE/OgreManualObject.h>
+#include <OGRE/OgreMaterialManager.h>
+#include <OGRE/OgreTechnique.h>
+
+#include <bumper/accumulator.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace mrs_rviz_plugins
+{
+
+  namespace bumper
+  {
+
+    int Accumulator::accumulator_idx = 0;
+
+    Accumulator::Accumulator(Ogre::SceneManager* scene_manager, Ogre::SceneNode* parent_node)
+    {
+      Accumulator::accumulator_idx++;
+      m_n_sectors = 0;
+      m_n_dist_bins = 50;
+      m_max_range = 10.0f;
+      m_decay = 0.95f;
+      m_color_r = m_color_g = m_color_b = m_color_a = 1.0f;
+      m_dirty = false;
+
+      scene_manager_ = scene_manager;
+      frame_node_ = parent_node->createChildSceneNode();
+
+      // the color of each cell is given by its vertices, so the material only has to enable transparency
+      const std::string name = "bumper_accumulator" + std::to_string(accumulator_idx);
+      material_ = Ogre::MaterialManager::getSingleton().create(name + "_material", Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+      material_->setReceiveShadows(false);
+      material_->setCullingMode(Ogre::CULL_NONE);
+      material_->getTechnique(0)->setLightingEnabled(false);
+      material_->getTechnique(0)->setSceneBlending(Ogre::SBT_TRANSPARENT_ALPHA);
+      material_->getTechnique(0)->setDepthWriteEnabled(false);
+
+      manual_object_ = scene_manager_->createManualObject(name);
+      manual_object_->setDynamic(true);
+      frame_node_->attachObject(manual_object_);
+    }
+
+    Accumulator::~Accumulator()
+    {
+      scene_manager_->destroyManualObject(manual_object_);
+      Ogre::MaterialManager::getSingleton().remove(material_->getName());
+      scene_manager_->destroySceneNode(frame_node_);
+    }
+
+    /* addMessage() method //{ */
+    void Accumulator::addMessage(const msg_t::ConstPtr& msg)
+    {
+      if (msg->n_horizontal_sectors != m_n_sectors)
+        resize(msg->n_horizontal_sectors, m_n_dist_bins);
+
+      for (auto& cell : m_histogram)
+        cell *= m_decay;
+
+      const float bin_size = m_max_range / m_n_dist_bins;
+      for (unsigned sector_it = 0; sector_it < m_n_sectors; sector_it++)
+      {
+        // the special values (no obstacle detected, no data) are negative
+        const double dist = msg->sectors.at(sector_it);
+        if (dist < 0.0 || dist >= m_max_range)
+          continue;
+        const unsigned bin_it = std::min(unsigned(dist / bin_size), m_n_dist_bins - 1);
+        m_histogram.at(sector_it * m_n_dist_bins + bin_it) += 1.0f;
+      }
+
+      m_dirty = true;
+    }
+    //}
+
+    /* update() method //{ */
+    void Accumulator::update()
+    {
+      if (!m_dirty)
+        return;
+      redraw();
+      m_dirty = false;
+    }
+    //}
+
+    /* clear() method //{ */
+    void Accumulator::clear()
+    {
+      std::fill(std::begin(m_histogram), std::end(m_histogram), 0.0f);
+      m_dirty = true;
+    }
+    //}
+
+    /* resize() method //{ */
+    void Accumulator::resize(unsigned n_sectors, unsigned n_dist_bins)
+    {
+      m_n_sectors = n_sectors;
+      m_n_dist_bins = n_dist_bins;
+      m_histogram.assign(m_n_sectors * m_n_dist_bins, 0.0f);
+      m_dirty = true;
+    }
+    //}
+
+    /* redraw() method //{ */
+    void Accumulator::redraw()
+    {
+      manual_object_->clear();
+      if (m_n_sectors == 0)
+        return;
+
+      // a cell which is hit by every message converges to 1/(1-decay), which is drawn fully opaque
+      const float normalization = 1.0f - std::min(m_decay, 0.999f);
+      constexpr float min_alpha = 0.01f;
+      // each cell is drawn as an annular segment, approximated by several trapezoids
+      constexpr unsigned n_arc_segments = 4;
+
+      const float hfov = 2.0f * M_PI / m_n_sectors;
+      const float arc_step = hfov / n_arc_segments;
+      const float bin_size = m_max_range / m_n_dist_bins;
+
+      manual_object_->begin(material_->getName(), Ogre::RenderOperation::OT_TRIANGLE_LIST);
+      for (unsigned sector_it = 0; sector_it < m_n_sectors; sector_it++)
+      {
+        const float yaw_start = hfov * sector_it - hfov / 2.0f;
+        for (unsigned bin_it = 0; bin_it < m_n_dist_bins; bin_it++)
+        {
+          const float alpha = std::min(m_histogram[sector_it * m_n_dist_bins + bin_it] * normalization, 1.0f) * m_color_a;
+          if (alpha < min_alpha)
+            continue;
+
+          const Ogre::ColourValue color(m_color_r, m_color_g, m_color_b, alpha);
+          const float r_in = bin_size * bin_it;
+          const float r_out = bin_size * (bin_it + 1);
+          for (unsigned arc_it = 0; arc_it < n_arc_segments; arc_it++)
+          {
+            const float a0 = yaw_start + arc_step * arc_it;
+            const float a1 = a0 + arc_step;
+            const Ogre::Vector3 in0(r_in * std::cos(a0), r_in * std::sin(a0), 0.0f);
+            const Ogre::Vector3 in1(r_in * std::cos(a1), r_in * std::sin(a1), 0.0f);
+            const Ogre::Vector3 out0(r_out * std::cos(a0), r_out * std::sin(a0), 0.0f);
+            const Ogre::Vector3 out1(r_out * std::cos(a1), r_out * std::sin(a1), 0.0f);
+
+            manual_object_->position(in0);
+            manual_object_->colour(color);
+            manual_object_->position(out0);
+            manual_object_->colour(color);
+            manual_object_->position(out1);
+            manual_object_->colour(color);
+
+            manual_object_->position(in0);
+            manual_object_->colour(color);
+            manual_object_->position(out1);
+            manual_object_->colour(color);
+            manual_object_->position(in1);
+            manual_object_->colour(color);
+          }
+        }
+      }
+      manual_object_->end();
+    }
+    //}
+
+    // Position and orientation are passed through to the SceneNode.
+    void Accumulator::setFramePosition(const Ogre::Vector3& position)
+    {
+      frame_node_->setPosition(position);
+    }
+
+    void Accumulator::setFrameOrientation(const Ogre::Quaternion& orientation)
+    {
+      frame_node_->setOrientation(orientation);
+    }
+
+    void Accumulator::setColor(float r, float g, float b, float a)
+    {
+      m_color_r = r;
+      m_color_g = g;
+      m_color_b = b;
+      m_color_a = a;
+      m_dirty = true;
+    }
+
+    void Accumulator::setDecay(float decay)
+    {
+      m_decay = decay;
+      m_dirty = true;
+    }
+
+    void Accumulator::setRange(float max_range, unsigned n_dist_bins)
+    {
+      if (max_range == m_max_range && n_dist_bins == m_n_dist_bins)
+        return;
+      m_max_range = max_range;
+      // the accumulated values cannot be remapped to the new bins, so start over
+      resize(m_n_sectors, n_dist_bins);
+    }
+
+  }  // namespace bumper
+
+}  // end namespace mrs_rviz_plugins
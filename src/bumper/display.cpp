@@ -15,6 +15,7 @@
 #include <rviz/frame_manager.h>
 
 #include <bumper/visual.h>
+#include <bumper/accumulator.h>
 #include <bumper/display.h>
 
 //}
@@ -65,6 +66,36 @@ namespace mrs_rviz_plugins
                                                          this, SLOT(updateShowUndetected()));
       show_no_data_property_ = new rviz::BoolProperty("Show sectors with no data", false, "Whether to show sectors, for which no sensory data is available.",
                                                       this, SLOT(updateShowUndetected()));
+      hysteresis_property_ = new rviz::FloatProperty(
+          "Distance hysteresis", 0.05, "Sectors whose obstacle distance changed by less than this value [m] since they were last drawn are not redrawn.",
+          this, SLOT(updateHysteresis()));
+      hysteresis_property_->setMin(0.0);
+
+      accumulate_property_ = new rviz::BoolProperty(
+          "Accumulate obstacles", false,
+          "Whether to accumulate the detected obstacles into a decaying polar histogram to show where obstacles have been recently.", this,
+          SLOT(updateAccumulation()));
+      accumulate_property_->setDisableChildrenIfFalse(true);
+
+      accumulate_alpha_property_ = new rviz::FloatProperty("Alpha", 0.8, "Opacity of the most often detected obstacles.", accumulate_property_,
+                                                           SLOT(updateAccumulation()), this);
+      accumulate_alpha_property_->setMin(0.0);
+      accumulate_alpha_property_->setMax(1.0);
+
+      accumulate_decay_property_ = new rviz::FloatProperty(
+          "Decay", 0.95, "Factor by which the accumulated obstacles are multiplied with each new message (higher means longer memory).",
+          accumulate_property_, SLOT(updateAccumulation()), this);
+      accumulate_decay_property_->setMin(0.0);
+      accumulate_decay_property_->setMax(0.999);
+
+      accumulate_range_property_ = new rviz::FloatProperty("Range", 10.0, "Maximal distance of the accumulated obstacles [m].", accumulate_property_,
+                                                           SLOT(updateAccumulation()), this);
+      accumulate_range_property_->setMin(0.1);
+
+      accumulate_bins_property_ =
+          new rviz::IntProperty("Distance bins", 50, "Number of distance bins per sector.", accumulate_property_, SLOT(updateAccumulation()), this);
+      accumulate_bins_property_->setMin(1);
+      accumulate_bins_property_->setMax(1000);
     }
 
     //}
@@ -84,6 +115,7 @@ namespace mrs_rviz_plugins
       MFDClass::onInitialize();
       updateHistoryLength();
       updateCollisions();
+      updateAccumulation();
     }
 
     Display::~Display()
@@ -95,6 +127,9 @@ namespace mrs_rviz_plugins
     {
       MFDClass::reset();
       visuals_.clear();
+      pending_msg_ = nullptr;
+      if (accumulator_)
+        accumulator_->clear();
     }
 
     // Set the current color and alpha values for each visual.
@@ -107,6 +142,9 @@ namespace mrs_rviz_plugins
       {
         visuals_[i]->setColor(color.r, color.g, color.b, alpha);
       }
+
+      if (accumulator_)
+        accumulator_->setColor(color.r, color.g, color.b, accumulate_alpha_property_->getFloat());
     }
 
     // Set the current color and alpha values for each visual.
@@ -166,6 +204,33 @@ namespace mrs_rviz_plugins
       }
     }
 
+    void Display::updateHysteresis()
+    {
+      float hysteresis = hysteresis_property_->getFloat();
+
+      for (size_t i = 0; i < visuals_.size(); i++)
+      {
+        visuals_[i]->setHysteresis(hysteresis);
+      }
+    }
+
+    void Display::updateAccumulation()
+    {
+      if (!accumulate_property_->getBool())
+      {
+        accumulator_ = nullptr;
+        return;
+      }
+
+      if (!accumulator_)
+        accumulator_ = std::make_unique<Accumulator>(context_->getSceneManager(), scene_node_);
+
+      Ogre::ColourValue color = color_property_->getOgreColor();
+      accumulator_->setColor(color.r, color.g, color.b, accumulate_alpha_property_->getFloat());
+      accumulator_->setDecay(accumulate_decay_property_->getFloat());
+      accumulator_->setRange(accumulate_range_property_->getFloat(), accumulate_bins_property_->getInt());
+    }
+
     // This is our callback to handle an incoming message.
     void Display::processMessage(const mrs_msgs::ObstacleSectors::ConstPtr& msg)
     {
@@ -185,6 +250,30 @@ namespace mrs_rviz_plugins
         }
       }
 
+      // Every message is accumulated (which is cheap), but the mesh is only
+      // rebuilt in update().
+      if (accumulator_)
+        accumulator_->addMessage(msg);
+
+      // The message is only drawn in the next update() call, so that a burst
+      // of messages between two frames costs a single transform and redraw.
+      pending_msg_ = msg;
+    }
+
+    void Display::update([[maybe_unused]] float wall_dt, [[maybe_unused]] float ros_dt)
+    {
+      if (pending_msg_ != nullptr)
+      {
+        applyMessage(pending_msg_);
+        pending_msg_ = nullptr;
+      }
+
+      if (accumulator_)
+        accumulator_->update();
+    }
+
+    void Display::applyMessage(const mrs_msgs::ObstacleSectors::ConstPtr& msg)
+    {
       // Here we call the rviz::FrameManager to get the transform from the
       // fixed frame to the frame in the header of this bumper_ message.  If
       // it fails, we can't do anything else so we return.
@@ -228,11 +317,20 @@ namespace mrs_rviz_plugins
       bool show_no_data = show_no_data_property_->getBool();
       visual->setShowNoData(show_no_data);
 
+      float hysteresis = hysteresis_property_->getFloat();
+      visual->setHysteresis(hysteresis);
+
       // Now set or update the contents of the chosen visual.
       visual->setMessage(msg);
       visual->setFramePosition(position);
       visual->setFrameOrientation(orientation);
 
+      if (accumulator_)
+      {
+        accumulator_->setFramePosition(position);
+        accumulator_->setFrameOrientation(orientation);
+      }
+
       // And send it to the end of the circular buffer
       visuals_.push_back(visual);
     }
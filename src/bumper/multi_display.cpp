@@ -0,0 +1,340 @@
+// clang: MatousFormat
+
+/* includes //{ */
+
+#include <OGRE/OgreSceneNode.h>
+#include <OGRE/OgreSceneManager.h>
+#include <OGRE/OgreManualObject.h>
+#include <OGRE/OgreMaterialManager.h>
+#include <OGRE/OgreTechnique.h>
+
+#include <rviz/display_context.h>
+#include <rviz/frame_manager.h>
+#include <rviz/properties/bool_property.h>
+#include <rviz/properties/color_property.h>
+#include <rviz/properties/float_property.h>
+#include <rviz/properties/string_property.h>
+#include <rviz/properties/status_property.h>
+
+#include <bumper/multi_display.h>
+
+//}
+
+namespace mrs_rviz_plugins
+{
+
+  namespace bumper
+  {
+
+    /* MultiDisplay::MultiDisplay() //{ */
+
+    MultiDisplay::MultiDisplay() : uavs_(this, update_nh_, &MultiDisplay::isValid), dirty_(false)
+    {
+      topic_pattern_property_ = new rviz::StringProperty("Topic pattern", ".*/bumper/obstacle_sectors",
+                                                         "Regular expression matched against the names of mrs_msgs/ObstacleSectors topics to display.",
+                                                         this, SLOT(updateTopicPattern()));
+
+      color_property_ = new rviz::ColorProperty("Color", QColor(204, 51, 204), "Color to draw the shapes.", this, SLOT(updateAppearance()));
+
+      alpha_property_ = new rviz::FloatProperty("Alpha", 0.1, "0 is fully transparent, 1.0 is fully opaque.", this, SLOT(updateAppearance()));
+      alpha_property_->setMin(0.0);
+      alpha_property_->setMax(1.0);
+
+      collision_colorize_property_ =
+          new rviz::BoolProperty("Colorize collisions", true, "If true, sectors with obstacles closer than Collision threshold will be colored differently.",
+                                 this, SLOT(updateAppearance()));
+      collision_colorize_property_->setDisableChildrenIfFalse(true);
+
+      horizontal_collision_threshold_property_ = new rviz::FloatProperty(
+          "Horizontal collision threshold", 1.0, "If an obstacle is closer than this threshold, the respective sector is colored differently.",
+          collision_colorize_property_, SLOT(updateAppearance()), this);
+
+      vertical_collision_threshold_property_ = new rviz::FloatProperty(
+          "Vertical collision threshold", 1.0, "If an obstacle is closer than this threshold, the respective sector is colored differently.",
+          collision_colorize_property_, SLOT(updateAppearance()), this);
+
+      collision_color_property_ = new rviz::ColorProperty("Collision color", QColor(255, 0, 0), "Color to draw sectors with collision.",
+                                                          collision_colorize_property_, SLOT(updateAppearance()), this);
+
+      collision_alpha_property_ = new rviz::FloatProperty("Collision alpha", 0.5, "0 is fully transparent, 1.0 is fully opaque.",
+                                                          collision_colorize_property_, SLOT(updateAppearance()), this);
+      collision_alpha_property_->setMin(0.0);
+      collision_alpha_property_->setMax(1.0);
+    }
+
+    //}
+
+    /* MultiDisplay::~MultiDisplay() //{ */
+
+    MultiDisplay::~MultiDisplay()
+    {
+      // the meshes of the UAVs are destroyed with them, before their material
+      uavs_.clear();
+      if (!material_.isNull())
+        Ogre::MaterialManager::getSingleton().remove(material_->getName());
+    }
+
+    //}
+
+    /* onInitialize() //{ */
+
+    void MultiDisplay::onInitialize()
+    {
+      static int multi_display_idx = 0;
+      const std::string name = "bumper_multi_display" + std::to_string(multi_display_idx++);
+
+      // all UAVs share this material, the colors of the sectors are given by their vertices
+      material_ = Ogre::MaterialManager::getSingleton().create(name + "_material", Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+      material_->setReceiveShadows(false);
+      material_->setCullingMode(Ogre::CULL_NONE);
+      material_->getTechnique(0)->setLightingEnabled(false);
+      material_->getTechnique(0)->setSceneBlending(Ogre::SBT_TRANSPARENT_ALPHA);
+      material_->getTechnique(0)->setDepthWriteEnabled(false);
+
+      updateTopicPattern();
+    }
+
+    //}
+
+    /* onEnable() and onDisable() //{ */
+
+    void MultiDisplay::onEnable()
+    {
+      uavs_.subscribe();
+    }
+
+    void MultiDisplay::onDisable()
+    {
+      uavs_.unsubscribe();
+      reset();
+    }
+
+    //}
+
+    /* reset() //{ */
+
+    void MultiDisplay::reset()
+    {
+      rviz::Display::reset();
+      uavs_.reset();
+      dirty_ = true;
+    }
+
+    //}
+
+    /* fixedFrameChanged() //{ */
+
+    void MultiDisplay::fixedFrameChanged()
+    {
+      // the stored transforms are relative to the old fixed frame, look them up again
+      uavs_.reprocess();
+    }
+
+    //}
+
+    /* updateTopicPattern() //{ */
+
+    void MultiDisplay::updateTopicPattern()
+    {
+      uavs_.setPattern(topic_pattern_property_->getStdString());
+      dirty_ = true;
+    }
+
+    //}
+
+    /* updateAppearance() //{ */
+
+    void MultiDisplay::updateAppearance()
+    {
+      dirty_ = true;
+      context_->queueRender();
+    }
+
+    //}
+
+    /* isValid() //{ */
+
+    bool MultiDisplay::isValid(const msg_t& msg, const std::string& topic)
+    {
+      // Sanitize the message to prevent Rviz crashes
+      if (msg.n_horizontal_sectors != msg.sectors.size() - 2 || msg.n_horizontal_sectors == 0)
+      {
+        ROS_DEBUG("[MultiDisplay]: n_horizontal_sectors (%u) is not equal to length of sectors (%lu)-2 in the ObstacleSectors message on '%s'!",
+                  msg.n_horizontal_sectors, msg.sectors.size(), topic.c_str());
+        return false;
+      }
+      for (const auto cur_len : msg.sectors)
+      {
+        if (std::isinf(cur_len) || std::isnan(cur_len))
+        {
+          ROS_DEBUG("[MultiDisplay]: Invalid obstacle distance encountered in mrs_msgs::ObstacleSectors message on '%s': %.2f, skipping message",
+                    topic.c_str(), cur_len);
+          return false;
+        }
+      }
+      return true;
+    }
+
+    //}
+
+    /* update() //{ */
+
+    void MultiDisplay::update(float wall_dt, [[maybe_unused]] float ros_dt)
+    {
+      uavs_.update(wall_dt);
+
+      // a change of the appearance rebuilds the meshes of all UAVs, a message only the one of its UAV
+      bool changed = false;
+      for (auto& kv : uavs_)
+      {
+        auto& uav = kv.second;
+        if (!uav.new_msg && !dirty_)
+          continue;
+        changed = true;
+
+        if (uav.new_msg)
+        {
+          uav.new_msg = false;
+          // Here we call the rviz::FrameManager to get the transform from the
+          // fixed frame to the frame in the header of this bumper message.
+          Ogre::Vector3 position;
+          Ogre::Quaternion orientation;
+          uav.valid = multi_display::getTransform(context_->getFrameManager(), uav.msg->header, position, orientation);
+          if (uav.valid && uav.node)
+          {
+            uav.node->setPosition(position);
+            uav.node->setOrientation(orientation);
+          }
+          else if (uav.valid)
+          {
+            uav.node.reset(scene_node_->createChildSceneNode(position, orientation),
+                           [scene_manager = scene_manager_](Ogre::SceneNode* node) { scene_manager->destroySceneNode(node); });
+          }
+          else
+            ROS_DEBUG("[MultiDisplay]: Error transforming from frame '%s' to frame '%s'", uav.msg->header.frame_id.c_str(), qPrintable(fixed_frame_));
+        }
+
+        redraw(uav);
+      }
+      dirty_ = false;
+
+      if (changed)
+        context_->queueRender();
+    }
+
+    //}
+
+    /* getTemplate() //{ */
+
+    const MultiDisplay::sector_template_t& MultiDisplay::getTemplate(const msg_t& msg)
+    {
+      const auto key = std::make_pair(msg.n_horizontal_sectors, msg.sectors_vertical_fov);
+      const auto found = templates_.find(key);
+      if (found != std::end(templates_))
+        return found->second;
+
+      sector_template_t& tmpl = templates_[key];
+      const unsigned n_hor = msg.n_horizontal_sectors;
+      const double hfov = 2.0 * M_PI / n_hor;
+      const double vfov = msg.sectors_vertical_fov;
+
+      // the same shape as in Visual::draw_horizontal_sector() with yaw = 0 and dist = 1
+      const Ogre::Vector3 pts[] = {Ogre::Vector3(0, 0, 0), Ogre::Vector3(cos(-hfov / 2.0), sin(-hfov / 2.0), tan(+vfov / 2.0)),
+                                   Ogre::Vector3(cos(-hfov / 2.0), sin(-hfov / 2.0), tan(-vfov / 2.0)),
+                                   Ogre::Vector3(cos(+hfov / 2.0), sin(+hfov / 2.0), tan(-vfov / 2.0)),
+                                   Ogre::Vector3(cos(+hfov / 2.0), sin(+hfov / 2.0), tan(+vfov / 2.0))};
+      for (const int idx : {0, 1, 2, 0, 2, 3, 0, 3, 4, 0, 4, 1, 1, 2, 3, 3, 4, 1})
+        tmpl.horizontal.push_back(pts[idx]);
+
+      for (unsigned sector_it = 0; sector_it < n_hor; sector_it++)
+        tmpl.yaws.emplace_back(Ogre::Radian(hfov * sector_it), Ogre::Vector3::UNIT_Z);
+
+      // the same shape as in Visual::draw_topdown_sector() with dist = 1
+      std::vector<Ogre::Vector3> rim(n_hor);
+      for (unsigned sector_it = 0; sector_it < n_hor; sector_it++)
+      {
+        const double cur_yaw = hfov * sector_it;
+        rim.at(sector_it) = Ogre::Vector3(cos(cur_yaw - hfov / 2.0) / tan(vfov / 2.0), sin(cur_yaw - hfov / 2.0) / tan(vfov / 2.0), 1.0);
+      }
+      for (unsigned sector_it = 0; sector_it < n_hor; sector_it++)
+      {
+        const unsigned next_sector_it = (sector_it + 1) % n_hor;
+        tmpl.topdown.push_back(Ogre::Vector3::ZERO);
+        tmpl.topdown.push_back(rim.at(sector_it));
+        tmpl.topdown.push_back(rim.at(next_sector_it));
+
+        tmpl.topdown.push_back(rim.at(sector_it));
+        tmpl.topdown.push_back(rim.at(next_sector_it));
+        tmpl.topdown.push_back(Ogre::Vector3::UNIT_Z);
+      }
+
+      return tmpl;
+    }
+
+    //}
+
+    /* redraw() //{ */
+
+    void MultiDisplay::redraw(uav_t& uav)
+    {
+      if (uav.object)
+        uav.object->clear();
+      if (!uav.valid)
+        return;
+
+      if (!uav.object)
+      {
+        static int uav_object_idx = 0;
+        uav.object.reset(scene_manager_->createManualObject("bumper_multi_display_uav" + std::to_string(uav_object_idx++)),
+                         [scene_manager = scene_manager_](Ogre::ManualObject* object) { scene_manager->destroyManualObject(object); });
+        uav.object->setDynamic(true);
+        uav.node->attachObject(uav.object.get());
+      }
+
+      Ogre::ColourValue color = color_property_->getOgreColor();
+      color.a = alpha_property_->getFloat();
+      Ogre::ColourValue collision_color = collision_color_property_->getOgreColor();
+      collision_color.a = collision_alpha_property_->getFloat();
+      const bool collision_colorize = collision_colorize_property_->getBool();
+      const float horizontal_threshold = horizontal_collision_threshold_property_->getFloat();
+      const float vertical_threshold = vertical_collision_threshold_property_->getFloat();
+
+      const auto& msg = *uav.msg;
+      const auto& tmpl = getTemplate(msg);
+      const unsigned n_hor = msg.n_horizontal_sectors;
+
+      // 18 vertices for each horizontal sector and 6 per horizontal sector for each of the two vertical ones
+      uav.object->estimateVertexCount(n_hor * 30);
+      uav.object->begin(material_->getName(), Ogre::RenderOperation::OT_TRIANGLE_LIST);
+      for (unsigned sector_it = 0; sector_it < n_hor + 2; sector_it++)
+      {
+        const double dist = msg.sectors.at(sector_it);
+        // the special values (no obstacle detected, no data) are negative
+        if (dist < 0.0)
+          continue;
+
+        const bool horizontal = sector_it < n_hor;
+        const bool colliding = collision_colorize && dist <= (horizontal ? horizontal_threshold : vertical_threshold);
+        const Ogre::ColourValue& cur_color = colliding ? collision_color : color;
+
+        // the shapes scale linearly with the distance, the down sector is the up sector scaled by -dist
+        const std::vector<Ogre::Vector3>& shape = horizontal ? tmpl.horizontal : tmpl.topdown;
+        const Ogre::Quaternion rot = horizontal ? tmpl.yaws.at(sector_it) : Ogre::Quaternion::IDENTITY;
+        const float scale = sector_it == n_hor ? -dist : dist;
+        for (const auto& pt : shape)
+        {
+          uav.object->position(rot * (pt * scale));
+          uav.object->colour(cur_color);
+        }
+      }
+      uav.object->end();
+    }
+
+    //}
+
+  }  // namespace bumper
+
+}  // end namespace mrs_rviz_plugins
+
+#include <pluginlib/class_list_macros.h>
+PLUGINLIB_EXPORT_CLASS(mrs_rviz_plugins::bumper::MultiDisplay, rviz::Display)
@@ -22,6 +22,13 @@ namespace mrs_rviz_plugins
     {
       m_arr_head_diameter = 0.2;
       m_arr_shaft_diameter = 0.1;
+      m_color_r = m_color_g = m_color_b = m_color_a = 0.0f;
+      m_show_undetected = true;
+      m_show_no_data = false;
+      m_collision_colorize = false;
+      m_collision_horizontal_threshold = m_collision_vertical_threshold = 0.0f;
+      m_collision_color_r = m_collision_color_g = m_collision_color_b = m_collision_color_a = 0.0f;
+      m_hysteresis = 0.0f;
       m_display_mode = display_mode_t::WHOLE_SECTORS;
       m_msg = nullptr;
 
@@ -330,76 +337,146 @@ namespace mrs_rviz_plugins
     /* setMessage() method //{ */
     void Visual::setMessage(const msg_t::ConstPtr& msg)
     {
+      const bool layout_changed = m_msg == nullptr || m_msg->n_horizontal_sectors != msg->n_horizontal_sectors ||
+                                  m_msg->sectors_vertical_fov != msg->sectors_vertical_fov;
       m_msg = msg;
-      draw_message(m_msg, m_display_mode);
+
+      // the shapes of all sectors depend on the layout, so everything has to be redrawn
+      if (layout_changed)
+      {
+        m_sectors.clear();
+        redraw();
+        return;
+      }
+
+      // otherwise, only redraw the sectors which changed noticeably since they were last drawn
+      boost::dynamic_bitset<> dirty(msg->sectors.size());
+      for (unsigned sector_it = 0; sector_it < dirty.size(); sector_it++)
+        dirty[sector_it] = sector_changed(sector_it);
+      draw_sectors(dirty);
     }
     //}
 
-    /* draw_message() method //{ */
-    void Visual::draw_message(const msg_t::ConstPtr& msg, display_mode_t display_mode)
+    /* redraw() method //{ */
+    void Visual::redraw()
     {
-      if (msg == nullptr)
+      if (m_msg == nullptr)
         return;
-    
-      const auto n_hor_sectors = msg->n_horizontal_sectors;
+
+      boost::dynamic_bitset<> dirty(m_msg->sectors.size());
+      dirty.set();
+      draw_sectors(dirty);
+    }
+    //}
+
+    /* sector_changed() method //{ */
+    bool Visual::sector_changed(const unsigned sector_it) const
+    {
+      const double new_len = m_msg->sectors.at(sector_it);
+      const double old_len = m_drawn_lens.at(sector_it);
+      if (new_len == old_len)
+        return m_display_mode == display_mode_t::SENSOR_TYPES && m_msg->sector_sensors.at(sector_it) != m_drawn_sensors.at(sector_it);
+
+      // switching from or to one of the special values always changes the drawn object
+      const auto is_special = [](const double len) { return len == msg_t::OBSTACLE_NOT_DETECTED || len == msg_t::OBSTACLE_NO_DATA; };
+      if (is_special(new_len) || is_special(old_len))
+        return true;
+
+      if (m_display_mode == display_mode_t::SENSOR_TYPES && m_msg->sector_sensors.at(sector_it) != m_drawn_sensors.at(sector_it))
+        return true;
+
+      // crossing the collision threshold changes the color even for a small change of the distance
+      if (is_colliding(sector_it, new_len) != is_colliding(sector_it, old_len))
+        return true;
+
+      return std::abs(new_len - old_len) > m_hysteresis;
+    }
+    //}
+
+    /* is_colliding() method //{ */
+    bool Visual::is_colliding(const unsigned sector_it, const double dist) const
+    {
+      if (!m_collision_colorize || dist < 0.0)
+        return false;
+      if (sector_it < m_msg->n_horizontal_sectors)
+        return dist <= m_collision_horizontal_threshold;
+      else
+        return dist <= m_collision_vertical_threshold;
+    }
+    //}
+
+    /* draw_sectors() method //{ */
+    void Visual::draw_sectors(const boost::dynamic_bitset<>& dirty)
+    {
+      m_sectors.resize(dirty.size());
+      m_drawn_lens.resize(dirty.size());
+      m_drawn_sensors.resize(dirty.size());
+
+      for (auto sector_it = dirty.find_first(); sector_it != boost::dynamic_bitset<>::npos; sector_it = dirty.find_next(sector_it))
+      {
+        // destroy the old object before creating the new one
+        m_sectors.at(sector_it) = nullptr;
+        m_sectors.at(sector_it) = draw_sector_object(sector_it);
+        m_drawn_lens.at(sector_it) = m_msg->sectors.at(sector_it);
+        m_drawn_sensors.at(sector_it) = m_msg->sector_sensors.at(sector_it);
+      }
+    }
+    //}
+
+    /* draw_sector_object() method //{ */
+    std::shared_ptr<rviz::Object> Visual::draw_sector_object(const unsigned sector_it)
+    {
+      const auto n_hor_sectors = m_msg->n_horizontal_sectors;
       const double hfov = 2.0 * M_PI / n_hor_sectors;
-      const double vfov = msg->sectors_vertical_fov;
-      m_sectors.clear();
-      m_sectors.reserve(n_hor_sectors + 2);
-    
-      for (unsigned sector_it = 0; sector_it < n_hor_sectors + 2; sector_it++)
+      const double vfov = m_msg->sectors_vertical_fov;
+
+      constexpr double max_len = 666.0;
+      double cur_len = m_msg->sectors.at(sector_it);
+      std::shared_ptr<rviz::Object> object_ptr = nullptr;
+
+      if (cur_len == mrs_msgs::ObstacleSectors::OBSTACLE_NOT_DETECTED)
       {
-        constexpr double max_len = 666.0;
-        double cur_len = msg->sectors.at(sector_it);
-        std::shared_ptr<rviz::Object> object_ptr = nullptr;
-    
-        if (cur_len == mrs_msgs::ObstacleSectors::OBSTACLE_NOT_DETECTED)
-        {
-          if (m_show_undetected)
-            cur_len = max_len;
-          else
-            continue;
-        }
-    
-        if (cur_len == msg_t::OBSTACLE_NO_DATA)
-        {
-          if (m_show_no_data)
-            object_ptr = draw_no_data(sector_it, n_hor_sectors);
-          else
-            continue;
-        } else
+        if (m_show_undetected)
+          cur_len = max_len;
+        else
+          return nullptr;
+      }
+
+      if (cur_len == msg_t::OBSTACLE_NO_DATA)
+      {
+        if (m_show_no_data)
+          object_ptr = draw_no_data(sector_it, n_hor_sectors);
+        else
+          return nullptr;
+      } else
+      {
+        assert(cur_len >= 0.0);
+        switch (m_display_mode)
         {
-          assert(cur_len >= 0.0);
-          switch (display_mode)
+          default:
+          case display_mode_t::WHOLE_SECTORS:
           {
-            default:
-            case display_mode_t::WHOLE_SECTORS:
-            {
-              object_ptr = draw_sector(cur_len, vfov, hfov, sector_it, n_hor_sectors);
-              break;
-            }
-            case display_mode_t::SENSOR_TYPES:
-            {
-              const auto cur_sensor = msg->sector_sensors.at(sector_it);
-              object_ptr = draw_sensor(cur_len, vfov, hfov, cur_sensor, sector_it, n_hor_sectors);
-              break;
-            }
+            object_ptr = draw_sector(cur_len, vfov, hfov, sector_it, n_hor_sectors);
+            break;
+          }
+          case display_mode_t::SENSOR_TYPES:
+          {
+            const auto cur_sensor = m_msg->sector_sensors.at(sector_it);
+            object_ptr = draw_sensor(cur_len, vfov, hfov, cur_sensor, sector_it, n_hor_sectors);
+            break;
           }
         }
-    
-        if (object_ptr != nullptr)
-        {
-    
-          if (sector_it < n_hor_sectors && m_collision_colorize && cur_len >= 0.0 && cur_len <= m_collision_horizontal_threshold)
-            object_ptr->setColor(m_collision_color_r, m_collision_color_g, m_collision_color_b, m_collision_color_a);
-          else if (sector_it >= n_hor_sectors && m_collision_colorize && cur_len >= 0.0 && cur_len <= m_collision_vertical_threshold)
-            object_ptr->setColor(m_collision_color_r, m_collision_color_g, m_collision_color_b, m_collision_color_a);
-          else
-            object_ptr->setColor(m_color_r, m_color_g, m_color_b, m_color_a);
-    
-          m_sectors.push_back(object_ptr);
-        }
       }
+
+      if (object_ptr != nullptr)
+      {
+        if (is_colliding(sector_it, cur_len))
+          object_ptr->setColor(m_collision_color_r, m_collision_color_g, m_collision_color_b, m_collision_color_a);
+        else
+          object_ptr->setColor(m_color_r, m_color_g, m_color_b, m_color_a);
+      }
+
+      return object_ptr;
     }
     //}
 
@@ -414,38 +491,48 @@ namespace mrs_rviz_plugins
       frame_node_->setOrientation(orientation);
     }
 
-    // Color is passed through to the Arrow object.
+    // Color is passed through to the sector objects.
     void Visual::setColor(float r, float g, float b, float a)
     {
+      if (r == m_color_r && g == m_color_g && b == m_color_b && a == m_color_a)
+        return;
       m_color_r = r;
       m_color_g = g;
       m_color_b = b;
       m_color_a = a;
-      draw_message(m_msg, m_display_mode);
+      redraw();
     }
 
-    // Color is passed through to the Arrow object.
-
     void Visual::setDisplayMode(display_mode_t display_mode)
     {
+      if (display_mode == m_display_mode)
+        return;
       m_display_mode = display_mode;
-      draw_message(m_msg, m_display_mode);
+      redraw();
     }
 
     void Visual::setShowUndetected(bool show_undetected)
     {
+      if (show_undetected == m_show_undetected)
+        return;
       m_show_undetected = show_undetected;
-      draw_message(m_msg, m_display_mode);
+      redraw();
     }
 
     void Visual::setShowNoData(bool show_no_data)
     {
+      if (show_no_data == m_show_no_data)
+        return;
       m_show_no_data = show_no_data;
-      draw_message(m_msg, m_display_mode);
+      redraw();
     }
 
     void Visual::setCollisionOptions(bool colorize, float horizontal_threshold, float vertical_threshold, float r, float g, float b, float a)
     {
+      if (colorize == m_collision_colorize && horizontal_threshold == m_collision_horizontal_threshold &&
+          vertical_threshold == m_collision_vertical_threshold && r == m_collision_color_r && g == m_collision_color_g && b == m_collision_color_b &&
+          a == m_collision_color_a)
+        return;
       m_collision_color_r = r;
       m_collision_color_g = g;
       m_collision_color_b = b;
@@ -453,7 +540,12 @@ namespace mrs_rviz_plugins
       m_collision_colorize = colorize;
       m_collision_horizontal_threshold = horizontal_threshold;
       m_collision_vertical_threshold = vertical_threshold;
-      draw_message(m_msg, m_display_mode);
+      redraw();
+    }
+
+    void Visual::setHysteresis(float hysteresis)
+    {
+      m_hysteresis = hysteresis;
     }
 
   }  // namespace bumper
@@ -0,0 +1,467 @@
+#include <covariance/batch_visual.h>
+#include <covariance/shape_cache.h>
+#include <lod/screen_size.h>
+
+#include <OgreCamera.h>
+#include <OgreSceneManager.h>
+#include <OgreSceneNode.h>
+#include <OgreManualObject.h>
+#include <OgreMaterialManager.h>
+#include <OgreTechnique.h>
+#include <OgrePass.h>
+#include <OgreSphere.h>
+
+#include <ros/console.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+namespace mrs_rviz_plugins
+{
+
+namespace covariance
+{
+
+namespace
+{
+
+// Triangle mesh with the same dimensions as the rviz meshes used by rviz::Shape
+struct Mesh
+{
+  std::vector<Ogre::Vector3> positions;
+  std::vector<Ogre::Vector3> normals;
+  std::vector<uint32_t>      indices;
+};
+
+// Sphere of diameter 1 centered at the origin
+Mesh makeSphere(unsigned n_rings, unsigned n_segments) {
+  Mesh mesh;
+  for (unsigned ring = 0; ring <= n_rings; ring++) {
+    const double theta = M_PI * ring / n_rings;
+    for (unsigned seg = 0; seg <= n_segments; seg++) {
+      const double        phi = 2.0 * M_PI * seg / n_segments;
+      const Ogre::Vector3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+      mesh.positions.push_back(0.5 * normal);
+      mesh.normals.push_back(normal);
+    }
+  }
+  for (unsigned ring = 0; ring < n_rings; ring++) {
+    for (unsigned seg = 0; seg < n_segments; seg++) {
+      const uint32_t i0 = ring * (n_segments + 1) + seg;
+      const uint32_t i1 = i0 + n_segments + 1;
+      mesh.indices.insert(mesh.indices.end(), {i0, i1, i0 + 1, i0 + 1, i1, i1 + 1});
+    }
+  }
+  return mesh;
+}
+
+// Cylinder of diameter 1 and height 1 along the y axis, centered at the origin. With apex_radius = 0 it is a cone.
+Mesh makeCylinder(unsigned n_segments, double apex_radius = 0.5) {
+  Mesh mesh;
+  // the side, the normals are perpendicular to the slant
+  const double slant = std::atan2(0.5 - apex_radius, 1.0);
+  for (unsigned seg = 0; seg <= n_segments; seg++) {
+    const double        phi = 2.0 * M_PI * seg / n_segments;
+    const Ogre::Vector3 dir(std::cos(phi), 0.0, std::sin(phi));
+    const Ogre::Vector3 normal = dir * std::cos(slant) + Ogre::Vector3::UNIT_Y * std::sin(slant);
+    mesh.positions.push_back(0.5 * dir - 0.5 * Ogre::Vector3::UNIT_Y);
+    mesh.normals.push_back(normal);
+    mesh.positions.push_back(apex_radius * dir + 0.5 * Ogre::Vector3::UNIT_Y);
+    mesh.normals.push_back(normal);
+  }
+  for (uint32_t seg = 0; seg < n_segments; seg++) {
+    const uint32_t i0 = 2 * seg;
+    mesh.indices.insert(mesh.indices.end(), {i0, i0 + 1, i0 + 2, i0 + 2, i0 + 1, i0 + 3});
+  }
+
+  // the caps
+  for (const double y : {-0.5, 0.5}) {
+    const double radius = y < 0.0 ? 0.5 : apex_radius;
+    if (radius <= 0.0)
+      continue;
+    const Ogre::Vector3 normal = y < 0.0 ? Ogre::Vector3::NEGATIVE_UNIT_Y : Ogre::Vector3::UNIT_Y;
+    const uint32_t      center = mesh.positions.size();
+    mesh.positions.push_back(Ogre::Vector3(0.0, y, 0.0));
+    mesh.normals.push_back(normal);
+    for (unsigned seg = 0; seg <= n_segments; seg++) {
+      const double phi = 2.0 * M_PI * seg / n_segments;
+      mesh.positions.push_back(Ogre::Vector3(radius * std::cos(phi), y, radius * std::sin(phi)));
+      mesh.normals.push_back(normal);
+    }
+    for (uint32_t seg = 0; seg < n_segments; seg++)
+      mesh.indices.insert(mesh.indices.end(), {center, center + 1 + seg, center + 2 + seg});
+  }
+  return mesh;
+}
+
+// Number of segments around the meshes for each level of detail, the finest one matches the rviz meshes
+constexpr std::array<int, 3> lod_segments = {6, 10, 16};
+const int                    n_lods       = lod_segments.size();
+const int                    culled       = -1;
+
+// Shapes with a smaller radius in pixels are not drawn at all
+const float min_screen_radius = 0.5f;
+
+// A drawn shape switches to a coarser level or is culled only once it would do so even if it was this many times larger,
+// so that the meshes are not rebuilt every frame while the camera moves and shapes hover around a threshold
+const float lod_hysteresis = 1.5f;
+
+const Mesh& sphereMesh(int lod) {
+  static const std::vector<Mesh> meshes = {makeSphere(4, lod_segments[0]), makeSphere(6, lod_segments[1]), makeSphere(10, lod_segments[2])};
+  return meshes[lod];
+}
+
+const Mesh& cylinderMesh(int lod) {
+  static const std::vector<Mesh> meshes = {makeCylinder(lod_segments[0]), makeCylinder(lod_segments[1]), makeCylinder(lod_segments[2])};
+  return meshes[lod];
+}
+
+const Mesh& coneMesh(int lod) {
+  static const std::vector<Mesh> meshes = {makeCylinder(lod_segments[0], 0.0), makeCylinder(lod_segments[1], 0.0), makeCylinder(lod_segments[2], 0.0)};
+  return meshes[lod];
+}
+
+// Level of detail of a shape bounded by the given sphere, culled if it is not in the view frustum or smaller than a pixel
+int selectLod(const Ogre::Camera* camera, const Ogre::Vector3& center, float radius, int current) {
+  if (!camera || !camera->getViewport())
+    return n_lods - 1;
+
+  const float hysteresis = current == culled ? 1.0f : lod_hysteresis;
+  if (!camera->isVisible(Ogre::Sphere(center, hysteresis * radius)))
+    return culled;
+  const float screen_radius = lod::screenRadius(camera, center, radius);
+  if (hysteresis * screen_radius < min_screen_radius)
+    return culled;
+
+  return lod::selectLod(screen_radius, lod_segments, current, hysteresis);
+}
+
+// Mirrors how Ogre combines the transform of a scene node with the one of its parent
+struct Transform
+{
+  Ogre::Vector3    position    = Ogre::Vector3::ZERO;
+  Ogre::Quaternion orientation = Ogre::Quaternion::IDENTITY;
+  Ogre::Vector3    scale       = Ogre::Vector3::UNIT_SCALE;
+
+  Transform child(const Ogre::Vector3& p, const Ogre::Quaternion& q, const Ogre::Vector3& s, bool inherit_scale = true) const {
+    Transform ret;
+    ret.position    = position + orientation * (scale * p);
+    ret.orientation = orientation * q;
+    ret.scale       = inherit_scale ? scale * s : s;
+    return ret;
+  }
+};
+
+void appendMesh(Ogre::ManualObject* object, const Mesh& mesh, const Transform& transform, const Ogre::ColourValue& color, uint32_t& n_vertices) {
+  // normals are transformed by the inverse of the scale, flat shapes have a tiny scale along one axis
+  const Ogre::Vector3 inv_scale(1.0 / std::max(std::abs(transform.scale.x), 1e-6f), 1.0 / std::max(std::abs(transform.scale.y), 1e-6f),
+                                1.0 / std::max(std::abs(transform.scale.z), 1e-6f));
+  for (size_t i = 0; i < mesh.positions.size(); i++) {
+    object->position(transform.position + transform.orientation * (transform.scale * mesh.positions[i]));
+    object->normal((transform.orientation * (inv_scale * mesh.normals[i])).normalisedCopy());
+    object->colour(color);
+  }
+  for (const uint32_t index : mesh.indices)
+    object->index(n_vertices + index);
+  n_vertices += mesh.positions.size();
+}
+
+void updateMaterialAlpha(const Ogre::MaterialPtr& material, float alpha) {
+  // Same as rviz::Shape::setColor()
+  if (alpha < 0.9998) {
+    material->getTechnique(0)->setSceneBlending(Ogre::SBT_TRANSPARENT_ALPHA);
+    material->getTechnique(0)->setDepthWriteEnabled(false);
+  } else {
+    material->getTechnique(0)->setSceneBlending(Ogre::SBT_REPLACE);
+    material->getTechnique(0)->setDepthWriteEnabled(true);
+  }
+}
+
+Ogre::MaterialPtr createMaterial(const std::string& name) {
+  Ogre::MaterialPtr material = Ogre::MaterialManager::getSingleton().create(name, Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+  material->setReceiveShadows(false);
+  // the flattened shapes are seen from both sides
+  material->setCullingMode(Ogre::CULL_NONE);
+  // the meshes are lit the same way as the rviz shapes, with the colors given by their vertices
+  material->getTechnique(0)->getPass(0)->setVertexColourTracking(Ogre::TVC_AMBIENT | Ogre::TVC_DIFFUSE);
+  return material;
+}
+
+}  // namespace
+
+int BatchVisual::batch_visual_idx = 0;
+
+BatchVisual::BatchVisual(Ogre::SceneManager* scene_manager, Ogre::SceneNode* parent_node, bool is_local_rotation)
+    : cache_(nullptr),
+      scene_manager_(scene_manager),
+      local_rotation_(is_local_rotation),
+      dirty_(false),
+      pos_scale_(1.0f),
+      ori_offset_(0.1f),
+      ori_scale_(0.1f),
+      pos_color_(Ogre::ColourValue::White),
+      ori_color_(Ogre::ColourValue::White),
+      ori_color_rgb_(false) {
+  const std::string name = "covariance_batch" + std::to_string(batch_visual_idx++);
+  root_node_             = parent_node->createChildSceneNode();
+
+  position_material_ = createMaterial(name + "_position_material");
+  position_object_   = scene_manager_->createManualObject(name + "_position");
+  position_object_->setDynamic(true);
+  root_node_->attachObject(position_object_);
+
+  orientation_material_ = createMaterial(name + "_orientation_material");
+  orientation_object_   = scene_manager_->createManualObject(name + "_orientation");
+  orientation_object_->setDynamic(true);
+  root_node_->attachObject(orientation_object_);
+}
+
+BatchVisual::~BatchVisual() {
+  scene_manager_->destroyManualObject(position_object_);
+  scene_manager_->destroyManualObject(orientation_object_);
+  Ogre::MaterialManager::getSingleton().remove(position_material_->getName());
+  Ogre::MaterialManager::getSingleton().remove(orientation_material_->getName());
+  scene_manager_->destroySceneNode(root_node_);
+}
+
+void BatchVisual::clear() {
+  instances_.clear();
+  dirty_ = true;
+}
+
+void BatchVisual::add(const Ogre::Vector3& position, const Ogre::Quaternion& orientation, const geometry_msgs::PoseWithCovariance& pose) {
+  const double source_position[3]    = {pose.pose.position.x, pose.pose.position.y, pose.pose.position.z};
+  const double source_orientation[4] = {pose.pose.orientation.x, pose.pose.orientation.y, pose.pose.orientation.z, pose.pose.orientation.w};
+  add(position, orientation, source_position, source_orientation, pose.covariance.data());
+}
+
+void BatchVisual::add(const Ogre::Vector3& position, const Ogre::Quaternion& orientation, const double* source_position, const double* source_orientation,
+                      const double* covariance) {
+  instances_.emplace_back();
+  Instance& instance   = instances_.back();
+  instance.position    = position;
+  instance.orientation = orientation;
+  // the source is filled in place, it is only read when the shape is computed
+  instance.source.pose.position.x    = source_position[0];
+  instance.source.pose.position.y    = source_position[1];
+  instance.source.pose.position.z    = source_position[2];
+  instance.source.pose.orientation.x = source_orientation[0];
+  instance.source.pose.orientation.y = source_orientation[1];
+  instance.source.pose.orientation.z = source_orientation[2];
+  instance.source.pose.orientation.w = source_orientation[3];
+  std::copy(covariance, covariance + 36, instance.source.covariance.begin());
+  // The largest eigenvalue of a covariance is bounded by its trace, which does not need the eigen decomposition
+  const double* cov          = covariance;
+  instance.position_sigma    = std::sqrt(std::max(cov[0] + cov[7] + cov[14], 0.0));
+  instance.orientation_sigma = std::sqrt(std::max(cov[21] + cov[28] + cov[35], 0.0));
+  instance.has_shape         = false;
+  instance.position_lod      = culled;
+  instance.orientation_lod   = culled;
+  dirty_                     = true;
+}
+
+void BatchVisual::setShapeCache(ShapeCache* cache) {
+  cache_ = cache;
+}
+
+void BatchVisual::update(const Ogre::Camera* camera) {
+  const Ogre::Matrix4 to_world   = root_node_->_getFullTransform();
+  const Ogre::Vector3 node_scale = root_node_->_getDerivedScale();
+  const float         max_scale  = std::max(std::abs(node_scale.x), std::max(std::abs(node_scale.y), std::abs(node_scale.z)));
+  // The orientation shapes are at most the orientation offset away from the pose and they span at most 89 degrees
+  const double max_half_angle = Ogre::Degree(Visual::max_degrees / 2.0).valueRadians();
+
+  bool                changed = dirty_;
+  std::vector<size_t> missing_shapes;
+  for (size_t it = 0; it < instances_.size(); it++) {
+    Instance&           instance = instances_[it];
+    const Ogre::Vector3 center   = to_world * instance.position;
+
+    int position_lod = culled;
+    if (position_object_->isVisible())
+      position_lod = selectLod(camera, center, max_scale * pos_scale_ * instance.position_sigma, instance.position_lod);
+
+    int orientation_lod = culled;
+    if (orientation_object_->isVisible()) {
+      const double half_width = std::tan(std::min(ori_scale_ * instance.orientation_sigma, max_half_angle));
+      orientation_lod         = selectLod(camera, center, max_scale * ori_offset_ * (1.0 + std::sqrt(2.0 * half_width * half_width + 0.25)), instance.orientation_lod);
+    }
+
+    if (!instance.has_shape && (position_lod != culled || orientation_lod != culled))
+      missing_shapes.push_back(it);
+    changed                  = changed || position_lod != instance.position_lod || orientation_lod != instance.orientation_lod;
+    instance.position_lod    = position_lod;
+    instance.orientation_lod = orientation_lod;
+  }
+
+  computeShapes(missing_shapes);
+  if (!changed)
+    return;
+  redraw();
+  dirty_ = false;
+}
+
+void BatchVisual::computeShapes(const std::vector<size_t>& indices) {
+  if (indices.empty())
+    return;
+
+  std::vector<geometry_msgs::PoseWithCovariance> sources;
+  sources.reserve(indices.size());
+  for (const size_t index : indices)
+    sources.push_back(instances_[index].source);
+
+  std::vector<Visual::Shape> shapes(indices.size());
+  if (cache_)
+    cache_->computeShapes(sources.begin(), sources.end(), shapes.begin());
+  else
+    Visual::computeShapes(sources.begin(), sources.end(), shapes.begin());
+
+  for (size_t it = 0; it < indices.size(); it++) {
+    instances_[indices[it]].shape     = shapes[it];
+    instances_[indices[it]].has_shape = true;
+  }
+}
+
+void BatchVisual::redraw() {
+  redrawPosition();
+  redrawOrientation();
+}
+
+void BatchVisual::redrawPosition() {
+  position_object_->clear();
+  if (instances_.empty())
+    return;
+
+  uint32_t n_vertices = 0;
+  position_object_->estimateVertexCount(instances_.size() * sphereMesh(n_lods - 1).positions.size());
+  position_object_->estimateIndexCount(instances_.size() * sphereMesh(n_lods - 1).indices.size());
+  position_object_->begin(position_material_->getName(), Ogre::RenderOperation::OT_TRIANGLE_LIST);
+  for (const auto& instance : instances_) {
+    // Same as Visual::setShape(), invalid covariances are not shown
+    const Visual::Shape& shape = instance.shape;
+    if (instance.position_lod == culled || !shape.valid)
+      continue;
+    if (shape.position_scale.isNaN()) {
+      ROS_WARN_STREAM("position shape_scale contains NaN: " << shape.position_scale);
+      continue;
+    }
+    // The same chain of nodes as in Visual: root, fixed orientation, position scale and position nodes
+    const Ogre::Vector3 pos_scale = shape.pose_2d ? Ogre::Vector3(pos_scale_, pos_scale_, 1.0) : Ogre::Vector3(pos_scale_);
+    const Transform     transform = Transform()
+                                    .child(instance.position, instance.orientation, Ogre::Vector3::UNIT_SCALE)
+                                    .child(Ogre::Vector3::ZERO, shape.fixed_orientation, Ogre::Vector3::UNIT_SCALE)
+                                    .child(Ogre::Vector3::ZERO, Ogre::Quaternion::IDENTITY, pos_scale)
+                                    .child(Ogre::Vector3::ZERO, shape.position_orientation, shape.position_scale);
+    appendMesh(position_object_, sphereMesh(instance.position_lod), transform, pos_color_, n_vertices);
+  }
+  position_object_->end();
+}
+
+void BatchVisual::redrawOrientation() {
+  orientation_object_->clear();
+  if (instances_.empty())
+    return;
+
+  const Ogre::ColourValue rgb_colors[Visual::kNumOriShapes] = {Ogre::ColourValue(1.0, 0.0, 0.0, ori_color_.a), Ogre::ColourValue(0.0, 1.0, 0.0, ori_color_.a),
+                                                               Ogre::ColourValue(0.0, 0.0, 1.0, ori_color_.a), Ogre::ColourValue(0.0, 0.0, 1.0, ori_color_.a)};
+
+  uint32_t n_vertices = 0;
+  orientation_object_->estimateVertexCount(instances_.size() * 3 * cylinderMesh(n_lods - 1).positions.size());
+  orientation_object_->estimateIndexCount(instances_.size() * 3 * cylinderMesh(n_lods - 1).indices.size());
+  orientation_object_->begin(orientation_material_->getName(), Ogre::RenderOperation::OT_TRIANGLE_LIST);
+  for (const auto& instance : instances_) {
+    const Visual::Shape& shape = instance.shape;
+    if (instance.orientation_lod == culled || !shape.valid)
+      continue;
+    // The orientation root node is attached either to the root node or to the fixed orientation node
+    Transform root = Transform().child(instance.position, instance.orientation, Ogre::Vector3::UNIT_SCALE);
+    if (!local_rotation_)
+      root = root.child(Ogre::Vector3::ZERO, shape.fixed_orientation, Ogre::Vector3::UNIT_SCALE);
+    root = root.child(Ogre::Vector3::ZERO, Ogre::Quaternion::IDENTITY, Ogre::Vector3(ori_offset_));
+
+    for (int i = 0; i < Visual::kNumOriShapes; i++) {
+      const Visual::ShapeIndex index = static_cast<Visual::ShapeIndex>(i);
+      if ((index == Visual::kYaw2D) != shape.pose_2d)
+        continue;
+
+      const Ogre::Vector3 shape_scale = Visual::getOrientationMetricScale(index, shape.orientation_scale[index], ori_scale_);
+      if (shape_scale.isNaN()) {
+        ROS_WARN_STREAM("orientation shape_scale contains NaN: " << shape_scale);
+        continue;
+      }
+
+      // The offset nodes do not inherit the scale of the orientation root node
+      Ogre::Vector3    offset_position;
+      Ogre::Quaternion offset_orientation;
+      Visual::getOrientationOffsetPose(index, offset_position, offset_orientation);
+      const Transform transform = root.child(offset_position, offset_orientation, Visual::getOrientationOffsetScale(index, ori_offset_), false)
+                                      .child(Ogre::Vector3::ZERO, shape.orientation_orientation[index], shape_scale);
+
+      const Mesh& mesh = index == Visual::kYaw2D ? coneMesh(instance.orientation_lod) : cylinderMesh(instance.orientation_lod);
+      appendMesh(orientation_object_, mesh, transform, ori_color_rgb_ ? rgb_colors[index] : ori_color_, n_vertices);
+    }
+  }
+  orientation_object_->end();
+}
+
+void BatchVisual::setPositionScale(float pos_scale) {
+  pos_scale_ = pos_scale;
+  dirty_     = true;
+}
+
+void BatchVisual::setOrientationOffset(float ori_offset) {
+  ori_offset_ = ori_offset;
+  dirty_      = true;
+}
+
+void BatchVisual::setOrientationScale(float ori_scale) {
+  ori_scale_ = ori_scale;
+  dirty_     = true;
+}
+
+void BatchVisual::setPositionColor(float r, float g, float b, float a) {
+  pos_color_ = Ogre::ColourValue(r, g, b, a);
+  updateMaterialAlpha(position_material_, a);
+  dirty_ = true;
+}
+
+void BatchVisual::setOrientationColor(float r, float g, float b, float a) {
+  ori_color_     = Ogre::ColourValue(r, g, b, a);
+  ori_color_rgb_ = false;
+  updateMaterialAlpha(orientation_material_, a);
+  dirty_ = true;
+}
+
+void BatchVisual::setOrientationColorToRGB(float a) {
+  ori_color_.a   = a;
+  ori_color_rgb_ = true;
+  updateMaterialAlpha(orientation_material_, a);
+  dirty_ = true;
+}
+
+void BatchVisual::setVisible(bool visible) {
+  setPositionVisible(visible);
+  setOrientationVisible(visible);
+}
+
+void BatchVisual::setPositionVisible(bool visible) {
+  position_object_->setVisible(visible);
+}
+
+void BatchVisual::setOrientationVisible(bool visible) {
+  orientation_object_->setVisible(visible);
+}
+
+void BatchVisual::setRotatingFrame(bool use_rotating_frame) {
+  if (local_rotation_ == use_rotating_frame)
+    return;
+  local_rotation_ = use_rotating_frame;
+  dirty_          = true;
+}
+
+}  // namespace covariance
+
+}  // namespace mrs_rviz_plugins
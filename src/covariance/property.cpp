@@ -98,9 +98,12 @@ void Property::updateColorAndAlphaAndScaleAndOffset() {
   D_Covariance::iterator end_cov = covariances_.end();
   for (; it_cov != end_cov; ++it_cov)
     updateColorAndAlphaAndScaleAndOffset(*it_cov);
+  for (const auto& batch_visual : batch_visuals_)
+    updateColorAndAlphaAndScaleAndOffset(batch_visual);
 }
 
-void Property::updateColorAndAlphaAndScaleAndOffset(const VisualPtr& visual) {
+template <typename T>
+void Property::updateColorAndAlphaAndScaleAndOffset(const T& visual) {
   float  pos_alpha = position_alpha_property_->getFloat();
   float  pos_scale = position_scale_property_->getFloat();
   QColor pos_color = position_color_property_->getColor();
@@ -125,9 +128,12 @@ void Property::updateVisibility() {
   D_Covariance::iterator end_cov = covariances_.end();
   for (; it_cov != end_cov; ++it_cov)
     updateVisibility(*it_cov);
+  for (const auto& batch_visual : batch_visuals_)
+    updateVisibility(batch_visual);
 }
 
-void Property::updateVisibility(const VisualPtr& visual) {
+template <typename T>
+void Property::updateVisibility(const T& visual) {
   bool show_covariance = getBool();
   if (!show_covariance) {
     visual->setVisible(false);
@@ -145,9 +151,12 @@ void Property::updateOrientationFrame() {
   D_Covariance::iterator end_cov = covariances_.end();
   for (; it_cov != end_cov; ++it_cov)
     updateOrientationFrame(*it_cov);
+  for (const auto& batch_visual : batch_visuals_)
+    updateOrientationFrame(batch_visual);
 }
 
-void Property::updateOrientationFrame(const VisualPtr& visual) {
+template <typename T>
+void Property::updateOrientationFrame(const T& visual) {
   bool use_rotating_frame = (orientation_frame_property_->getOptionInt() == Local);
   visual->setRotatingFrame(use_rotating_frame);
 }
@@ -174,6 +183,15 @@ Property::VisualPtr Property::createAndPushBackVisual(Ogre::SceneManager* scene_
   return visual;
 }
 
+Property::BatchVisualPtr Property::createBatchVisual(Ogre::SceneManager* scene_manager, Ogre::SceneNode* parent_node) {
+  bool           use_rotating_frame = (orientation_frame_property_->getOptionInt() == Local);
+  BatchVisualPtr visual(new BatchVisual(scene_manager, parent_node, use_rotating_frame));
+  updateVisibility(visual);
+  updateColorAndAlphaAndScaleAndOffset(visual);
+  batch_visuals_.push_back(visual);
+  return visual;
+}
+
 bool Property::getPositionBool() {
   return position_property_->getBool();
 }
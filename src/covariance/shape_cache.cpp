@@ -0,0 +1,61 @@
+#include <covariance/shape_cache.h>
+
+#include <boost/functional/hash.hpp>
+
+#include <cmath>
+
+namespace mrs_rviz_plugins
+{
+
+namespace covariance
+{
+
+ShapeCache::ShapeCache(double epsilon, size_t max_size) : epsilon_(epsilon), max_size_(max_size), hits_(0), misses_(0) {
+}
+
+size_t ShapeCache::KeyHash::operator()(const Key& key) const {
+  return boost::hash_range(key.begin(), key.end());
+}
+
+ShapeCache::Key ShapeCache::makeKey(const geometry_msgs::Pose& pose, const double* covariance) const {
+  // Values within the same multiple of epsilon map to the same key
+  Key key;
+  for (size_t i = 0; i < 36; i++)
+    key[i] = std::round(covariance[i] / epsilon_);
+  key[36] = std::round(pose.orientation.x / epsilon_);
+  key[37] = std::round(pose.orientation.y / epsilon_);
+  key[38] = std::round(pose.orientation.z / epsilon_);
+  key[39] = std::round(pose.orientation.w / epsilon_);
+  return key;
+}
+
+bool ShapeCache::find(const geometry_msgs::Pose& pose, const double* covariance, Visual::Shape& shape) {
+  const auto found = shapes_.find(makeKey(pose, covariance));
+  if (found == shapes_.end()) {
+    misses_++;
+    return false;
+  }
+  hits_++;
+  shape = found->second;
+  return true;
+}
+
+void ShapeCache::insert(const geometry_msgs::Pose& pose, const double* covariance, const Visual::Shape& shape) {
+  // A simple eviction policy is enough, the cache only pays off for covariances repeated in consecutive messages
+  if (shapes_.size() >= max_size_)
+    shapes_.clear();
+  shapes_[makeKey(pose, covariance)] = shape;
+}
+
+void ShapeCache::clear() {
+  shapes_.clear();
+}
+
+void ShapeCache::resetCounters() {
+  hits_   = 0;
+  misses_ = 0;
+}
+
+}  // namespace covariance
+
+}  // namespace mrs_rviz_plugins
@@ -1,4 +1,5 @@
 #include <covariance/visual.h>
+#include <covariance/math.h>
 
 #include <rviz/ogre_helpers/shape.h>
 #include <rviz/validate_quaternions.h>
@@ -65,23 +66,68 @@ void makeRightHanded(Eigen::Matrix2d& eigenvectors, Eigen::Vector2d& eigenvalues
   }
 }
 
+// Closed-form eigen decomposition of a symmetric 3x3 matrix. Eigen's computeDirect() solves the characteristic cubic
+// trigonometrically and takes the eigenvectors from cross products of the rows, handling repeated eigenvalues. It is
+// much faster than the iterative solver, but its error of the small eigenvalues grows with the condition number, so
+// a GPS-like covariance such as diag(1e-9, 1e-9, 1e6) may even get a negative one. Ill-conditioned matrices and
+// non-finite results (e.g. due to overflow) are therefore left to the iterative solver. The eigenvalues are sorted in
+// increasing order. Returns false if neither of them succeeds.
+bool eigenDecomposition3D(const Eigen::Matrix3d& covariance, Eigen::Vector3d& eigenvalues, Eigen::Matrix3d& eigenvectors) {
+  // The error of computeDirect() reaches about 1e-10 of the largest eigenvalue when the small ones are close to each
+  // other, this keeps the relative error of all the eigenvalues below 1e-6
+  constexpr double direct_max_condition = 1e4;
+
+  // NOTE: The SelfAdjointEigenSolver only references the lower triangular part of the covariance matrix
+  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigensolver;
+  eigensolver.computeDirect(covariance);
+  const Eigen::Vector3d& direct = eigensolver.eigenvalues();
+  if (eigensolver.info() != Eigen::Success || !direct.allFinite() || !eigensolver.eigenvectors().allFinite() ||
+      direct[0] * direct_max_condition < direct[2])
+    eigensolver.compute(covariance);
+  if (eigensolver.info() != Eigen::Success)
+    return false;
+  eigenvalues  = eigensolver.eigenvalues();
+  eigenvectors = eigensolver.eigenvectors();
+  return true;
+}
+
+// Closed-form eigen decomposition of a symmetric 2x2 matrix [a b; b c]. The eigenvectors are the axes rotated by the
+// angle of a single Jacobi rotation, theta = atan2(2b, a - c) / 2, which is also well defined for a diagonal matrix
+// with equal elements (theta = 0). The eigenvalues are sorted in increasing order. Returns false for a non-finite matrix.
+bool eigenDecomposition2D(const Eigen::Matrix2d& covariance, Eigen::Vector2d& eigenvalues, Eigen::Matrix2d& eigenvectors) {
+  // NOTE: Only the lower triangular part of the covariance matrix is referenced, same as with the SelfAdjointEigenSolver
+  const double a = covariance(0, 0);
+  const double b = covariance(1, 0);
+  const double c = covariance(1, 1);
+  if (!std::isfinite(a) || !std::isfinite(b) || !std::isfinite(c))
+    return false;
+
+  const double mean   = (a + c) / 2.0;
+  const double radius = std::hypot((a - c) / 2.0, b);
+  const double theta  = std::atan2(2.0 * b, a - c) / 2.0;
+  const double cos_t  = std::cos(theta);
+  const double sin_t  = std::sin(theta);
+
+  // (cos_t, sin_t) belongs to the larger eigenvalue
+  eigenvalues << mean - radius, mean + radius;
+  eigenvectors << -sin_t, cos_t, cos_t, sin_t;
+  return true;
+}
+
 void computeShapeScaleAndOrientation3D(const Eigen::Matrix3d& covariance, Ogre::Vector3& scale, Ogre::Quaternion& orientation) {
   Eigen::Vector3d eigenvalues(Eigen::Vector3d::Identity());
   Eigen::Matrix3d eigenvectors(Eigen::Matrix3d::Zero());
 
-  // NOTE: The SelfAdjointEigenSolver only references the lower triangular part of the covariance matrix
-  // FIXME: Should we use Eigen's pseudoEigenvectors() ?
-  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigensolver(covariance);
   // Compute eigenvectors and eigenvalues
-  if (eigensolver.info() == Eigen::Success) {
-    eigenvalues  = eigensolver.eigenvalues();
-    eigenvectors = eigensolver.eigenvectors();
-  } else {
+  if (!eigenDecomposition3D(covariance, eigenvalues, eigenvectors)) {
     ROS_WARN_THROTTLE(1, "failed to compute eigen vectors/values for position. Is the covariance matrix correct?");
     eigenvalues  = Eigen::Vector3d::Zero();  // Setting the scale to zero will hide it on the screen
     eigenvectors = Eigen::Matrix3d::Identity();
   }
 
+  // A covariance is positive semi-definite, negative eigenvalues of singular ones are round-off and would give NaN scales
+  eigenvalues = eigenvalues.cwiseMax(0.0);
+
   // Be sure we have a right-handed orientation system
   makeRightHanded(eigenvectors, eigenvalues);
 
@@ -95,30 +141,20 @@ void computeShapeScaleAndOrientation3D(const Eigen::Matrix3d& covariance, Ogre::
   scale.z = 2 * std::sqrt(eigenvalues[2]);
 }
 
-enum Plane
-{
-  YZ_PLANE,  // normal is x-axis
-  XZ_PLANE,  // normal is y-axis
-  XY_PLANE   // normal is z-axis
-};
-
-void computeShapeScaleAndOrientation2D(const Eigen::Matrix2d& covariance, Ogre::Vector3& scale, Ogre::Quaternion& orientation, Plane plane = XY_PLANE) {
+void computeShapeScaleAndOrientation2D(const Eigen::Matrix2d& covariance, Ogre::Vector3& scale, Ogre::Quaternion& orientation, Plane plane) {
   Eigen::Vector2d eigenvalues(Eigen::Vector2d::Identity());
   Eigen::Matrix2d eigenvectors(Eigen::Matrix2d::Zero());
 
-  // NOTE: The SelfAdjointEigenSolver only references the lower triangular part of the covariance matrix
-  // FIXME: Should we use Eigen's pseudoEigenvectors() ?
-  Eigen::SelfAdjointEigenSolver<Eigen::Matrix2d> eigensolver(covariance);
   // Compute eigenvectors and eigenvalues
-  if (eigensolver.info() == Eigen::Success) {
-    eigenvalues  = eigensolver.eigenvalues();
-    eigenvectors = eigensolver.eigenvectors();
-  } else {
+  if (!eigenDecomposition2D(covariance, eigenvalues, eigenvectors)) {
     ROS_WARN_THROTTLE(1, "failed to compute eigen vectors/values for position. Is the covariance matrix correct?");
     eigenvalues  = Eigen::Vector2d::Zero();  // Setting the scale to zero will hide it on the screen
     eigenvectors = Eigen::Matrix2d::Identity();
   }
 
+  // A covariance is positive semi-definite, negative eigenvalues of singular ones are round-off and would give NaN scales
+  eigenvalues = eigenvalues.cwiseMax(0.0);
+
   // Be sure we have a right-handed orientation system
   makeRightHanded(eigenvectors, eigenvalues);
 
@@ -157,6 +193,77 @@ void radianScaleToMetricScaleBounded(Ogre::Real& radian_scale, float max_degrees
 
 const float Visual::max_degrees = 89.0;
 
+void Visual::getOrientationOffsetPose(ShapeIndex index, Ogre::Vector3& position, Ogre::Quaternion& orientation) {
+  switch (index) {
+    // x-axis (roll)
+    case kRoll:
+      position    = Ogre::Vector3::UNIT_X;
+      orientation = Ogre::Quaternion(Ogre::Degree(90), Ogre::Vector3::UNIT_X) * Ogre::Quaternion(Ogre::Degree(90), Ogre::Vector3::UNIT_Z);
+      break;
+    // y-axis (pitch)
+    case kPitch:
+      position    = Ogre::Vector3::UNIT_Y;
+      orientation = Ogre::Quaternion(Ogre::Degree(90), Ogre::Vector3::UNIT_Y);
+      break;
+    // z-axis (yaw)
+    case kYaw:
+      position    = Ogre::Vector3::UNIT_Z;
+      orientation = Ogre::Quaternion(Ogre::Degree(90), Ogre::Vector3::UNIT_X);
+      break;
+    // z-axis (yaw 2D)
+    default:
+      // NOTE: rviz use a cone defined by the file rviz/ogre_media/models/rviz_cone.mesh, and it's
+      //       origin is not at the top of the cone. Since we want the top to be at the origin of
+      //       the pose we need to use an offset here.
+      // WARNING: This number was found by trial-and-error on rviz and it's not the correct
+      //          one, so changes on scale are expected to cause the top of the cone to move
+      //          from the pose origin, although it's only noticeable with big scales.
+      // FIXME: Find the right value from the cone.mesh file, or implement a class that draws
+      //        something like a 2D "pie slice" and use it instead of the cone.
+      static const double cone_origin_to_top = 0.49115;
+      position    = cone_origin_to_top * Ogre::Vector3::UNIT_X;
+      orientation = Ogre::Quaternion(Ogre::Degree(90), Ogre::Vector3::UNIT_Z);
+  }
+}
+
+Ogre::Vector3 Visual::getOrientationOffsetScale(ShapeIndex index, float ori_offset) {
+  // The scale the offset_nodes as well so the displayed shape represents a 1-sigma
+  // standard deviation when displayed with an scale of 1.0
+  // NOTE: We only want to change the scales of the dimentions that represent the
+  //       orientation covariance. The other dimensions are set to 1.0.
+  if (index == kYaw2D) {
+    // For 2D, the angle is only encoded on x, but we also scale on y to put the top of the cone at the pose origin
+    return Ogre::Vector3(ori_offset, ori_offset, 1.0);
+  } else {
+    // For 3D, the angle covariance is encoded on x and z dimensions
+    return Ogre::Vector3(ori_offset, 1.0, ori_offset);
+  }
+}
+
+Ogre::Vector3 Visual::getOrientationMetricScale(ShapeIndex index, const Ogre::Vector3& radian_scale, float ori_scale) {
+  Ogre::Vector3 shape_scale = radian_scale;
+  if (index == kYaw2D) {
+    // Changes in scale in 2D only affects the x dimension
+    // Apply the current scale factor
+    shape_scale.x *= ori_scale;
+    // The scale on x means twice the standard deviation, but _in radians_.
+    // So we need to convert it to the linear scale of the shape using tan().
+    // Also, we bound the maximum std
+    radianScaleToMetricScaleBounded(shape_scale.x, max_degrees);
+  } else {
+    // Changes in scale in 3D only affects the x and z dimensions
+    // Apply the current scale factor
+    shape_scale.x *= ori_scale;
+    shape_scale.z *= ori_scale;
+    // The computed scale is equivalent to twice the standard deviation _in radians_.
+    // So we need to convert it to the linear scale of the shape using tan().
+    // Also, we bound the maximum std.
+    radianScaleToMetricScaleBounded(shape_scale.x, max_degrees);
+    radianScaleToMetricScaleBounded(shape_scale.z, max_degrees);
+  }
+  return shape_scale;
+}
+
 Visual::Visual(Ogre::SceneManager* scene_manager, Ogre::SceneNode* parent_node, bool is_local_rotation, bool is_visible, float pos_scale, float ori_scale,
                float ori_offset)
     : Object(scene_manager), local_rotation_(is_local_rotation), pose_2d_(false), orientation_visible_(is_visible) {
@@ -193,28 +300,13 @@ Visual::Visual(Ogre::SceneManager* scene_manager, Ogre::SceneNode* parent_node,
   }
 
   // Position the cylindes at position 1.0 in the respective axis, and perpendicular to the axis.
-  // x-axis (roll)
-  orientation_offset_node_[kRoll]->setPosition(Ogre::Vector3::UNIT_X);
-  orientation_offset_node_[kRoll]->setOrientation(Ogre::Quaternion(Ogre::Degree(90), Ogre::Vector3::UNIT_X) *
-                                                  Ogre::Quaternion(Ogre::Degree(90), Ogre::Vector3::UNIT_Z));
-  // y-axis (pitch)
-  orientation_offset_node_[kPitch]->setPosition(Ogre::Vector3(Ogre::Vector3::UNIT_Y));
-  orientation_offset_node_[kPitch]->setOrientation(Ogre::Quaternion(Ogre::Degree(90), Ogre::Vector3::UNIT_Y));
-  // z-axis (yaw)
-  orientation_offset_node_[kYaw]->setPosition(Ogre::Vector3(Ogre::Vector3::UNIT_Z));
-  orientation_offset_node_[kYaw]->setOrientation(Ogre::Quaternion(Ogre::Degree(90), Ogre::Vector3::UNIT_X));
-  // z-axis (yaw 2D)
-  // NOTE: rviz use a cone defined by the file rviz/ogre_media/models/rviz_cone.mesh, and it's
-  //       origin is not at the top of the cone. Since we want the top to be at the origin of
-  //       the pose we need to use an offset here.
-  // WARNING: This number was found by trial-and-error on rviz and it's not the correct
-  //          one, so changes on scale are expected to cause the top of the cone to move
-  //          from the pose origin, although it's only noticeable with big scales.
-  // FIXME: Find the right value from the cone.mesh file, or implement a class that draws
-  //        something like a 2D "pie slice" and use it instead of the cone.
-  static const double cone_origin_to_top = 0.49115;
-  orientation_offset_node_[kYaw2D]->setPosition(cone_origin_to_top * Ogre::Vector3::UNIT_X);
-  orientation_offset_node_[kYaw2D]->setOrientation(Ogre::Quaternion(Ogre::Degree(90), Ogre::Vector3::UNIT_Z));
+  for (int i = 0; i < kNumOriShapes; i++) {
+    Ogre::Vector3    offset_position;
+    Ogre::Quaternion offset_orientation;
+    getOrientationOffsetPose(static_cast<ShapeIndex>(i), offset_position, offset_orientation);
+    orientation_offset_node_[i]->setPosition(offset_position);
+    orientation_offset_node_[i]->setOrientation(offset_orientation);
+  }
 
   // set initial visibility and scale
   // root node is always visible. The visibility will be updated on its childs.
@@ -238,91 +330,101 @@ Visual::~Visual() {
   scene_manager_->destroySceneNode(root_node_->getName());
 }
 
-void Visual::setCovariance(const geometry_msgs::PoseWithCovariance& pose) {
+void Visual::computeShape(const geometry_msgs::Pose& pose, const double* covariance_data, Shape& shape) {
+  shape.valid = false;
   // check for NaN in covariance
   for (unsigned i = 0; i < 3; ++i) {
-    if (std::isnan(pose.covariance[i])) {
+    if (std::isnan(covariance_data[i])) {
       ROS_WARN_THROTTLE(1, "covariance contains NaN");
       return;
     }
   }
+  shape.valid = true;
 
-  if (pose.covariance[14] <= 0 && pose.covariance[21] <= 0 && pose.covariance[28] <= 0)
-    pose_2d_ = true;
+  if (covariance_data[14] <= 0 && covariance_data[21] <= 0 && covariance_data[28] <= 0)
+    shape.pose_2d = true;
   else
-    pose_2d_ = false;
-
-  updateOrientationVisibility();
+    shape.pose_2d = false;
 
   // store orientation in Ogre structure
   Ogre::Quaternion ori;
-  rviz::normalizeQuaternion(pose.pose.orientation, ori);
+  rviz::normalizeQuaternion(pose.orientation, ori);
 
-  // Set the orientation of the fixed node. Since this node is attached to the root node, it's orientation will be the
+  // The orientation of the fixed node. Since this node is attached to the root node, it's orientation will be the
   // inverse of pose's orientation.
-  fixed_orientation_node_->setOrientation(ori.Inverse());
+  shape.fixed_orientation = ori.Inverse();
   // Map covariance to a Eigen::Matrix
-  Eigen::Map<const Eigen::Matrix<double, 6, 6>> covariance(pose.covariance.data());
-
+  Eigen::Map<const Eigen::Matrix<double, 6, 6>> covariance(covariance_data);
 
-  Eigen::Quaterniond qori(ori.w,ori.x,ori.y,ori.z);
-  Eigen::Matrix3d rotmat = qori.toRotationMatrix();
-  Eigen::Matrix6d covarianceRotated = covariance;
-  covarianceRotated.bottomRightCorner(3,3) = rotmat.transpose()*covariance.bottomRightCorner(3,3)*rotmat;
+  computePositionShape(covariance, shape.pose_2d, shape.position_scale, shape.position_orientation);
+  if (!shape.pose_2d) {
+    Eigen::Quaterniond qori(ori.w,ori.x,ori.y,ori.z);
+    Eigen::Matrix3d rotmat = qori.toRotationMatrix();
+    Eigen::Matrix6d covarianceRotated = covariance;
+    covarianceRotated.bottomRightCorner(3,3) = rotmat.transpose()*covariance.bottomRightCorner(3,3)*rotmat;
 
-  updatePosition(covariance);
-  if (!pose_2d_) {
-    updateOrientation(covarianceRotated, kRoll);
-    updateOrientation(covarianceRotated, kPitch);
-    updateOrientation(covarianceRotated, kYaw);
+    for (const ShapeIndex index : {kRoll, kPitch, kYaw})
+      computeOrientationShape(covarianceRotated, index, shape.orientation_scale[index], shape.orientation_orientation[index]);
   } else {
-    updateOrientation(covariance, kYaw2D);
+    computeOrientationShape(covariance, kYaw2D, shape.orientation_scale[kYaw2D], shape.orientation_orientation[kYaw2D]);
   }
 }
 
-void Visual::updatePosition(const Eigen::Matrix6d& covariance) {
+void Visual::setShape(const Shape& shape) {
+  if (!shape.valid)
+    return;
+
+  pose_2d_ = shape.pose_2d;
+  updateOrientationVisibility();
+
+  fixed_orientation_node_->setOrientation(shape.fixed_orientation);
+
+  // Rotate and scale the position scene node
+  position_node_->setOrientation(shape.position_orientation);
+  if (!shape.position_scale.isNaN())
+    position_node_->setScale(shape.position_scale);
+  else
+    ROS_WARN_STREAM("position shape_scale contains NaN: " << shape.position_scale);
+
+  // Rotate the scene nodes of the orientation part, the scale depends on the current scale factor
+  for (const ShapeIndex index : {kRoll, kPitch, kYaw, kYaw2D}) {
+    if ((index == kYaw2D) != pose_2d_)
+      continue;
+    // Store the computed scale to be used if the user change the scale
+    current_ori_scale_[index] = shape.orientation_scale[index];
+    orientation_shape_[index]->setOrientation(shape.orientation_orientation[index]);
+    updateOrientationScale(index);
+  }
+}
+
+void Visual::setCovariance(const geometry_msgs::PoseWithCovariance& pose) {
+  Shape shape;
+  computeShape(pose.pose, pose.covariance.data(), shape);
+  setShape(shape);
+}
+
+void Visual::computePositionShape(const Eigen::Matrix6d& covariance, bool pose_2d, Ogre::Vector3& shape_scale, Ogre::Quaternion& shape_orientation) {
   // Compute shape and orientation for the position part of covariance
-  Ogre::Vector3    shape_scale;
-  Ogre::Quaternion shape_orientation;
-  if (pose_2d_) {
+  if (pose_2d) {
     computeShapeScaleAndOrientation2D(covariance.topLeftCorner<2, 2>(), shape_scale, shape_orientation, XY_PLANE);
     // Make the scale in z minimal for better visualization
     shape_scale.z = 0.001;
   } else {
     computeShapeScaleAndOrientation3D(covariance.topLeftCorner<3, 3>(), shape_scale, shape_orientation);
   }
-  // Rotate and scale the position scene node
-  position_node_->setOrientation(shape_orientation);
-  if (!shape_scale.isNaN())
-    position_node_->setScale(shape_scale);
-  else
-    ROS_WARN_STREAM("position shape_scale contains NaN: " << shape_scale);
 }
 
-void Visual::updateOrientation(const Eigen::Matrix6d& covariance, ShapeIndex index) {
-  Ogre::Vector3    shape_scale;
-  Ogre::Quaternion shape_orientation;
+void Visual::computeOrientationShape(const Eigen::Matrix6d& covariance, ShapeIndex index, Ogre::Vector3& shape_scale, Ogre::Quaternion& shape_orientation) {
   // Compute shape and orientation for the orientation shape
-  if (pose_2d_) {
-    // We should only enter on this scope if the index is kYaw2D
-    assert(index == kYaw2D);
+  if (index == kYaw2D) {
     // 2D poses only depend on yaw.
     shape_scale.x = 2.0 * sqrt(covariance(5, 5));
     // To display the cone shape properly the scale along y-axis has to be one.
     shape_scale.y = 1.0;
     // Give a minimal height for the cone for better visualization
     shape_scale.z = 0.001;
-    // Store the computed scale to be used if the user change the scale
-    current_ori_scale_[index] = shape_scale;
-    // Apply the current scale factor
-    shape_scale.x *= current_ori_scale_factor_;
-    // The scale on x means twice the standard deviation, but _in radians_.
-    // So we need to convert it to the linear scale of the shape using tan().
-    // Also, we bound the maximum std
-    radianScaleToMetricScaleBounded(shape_scale.x, max_degrees);
+    shape_orientation = Ogre::Quaternion::IDENTITY;
   } else {
-    assert(index != kYaw2D);
-
     // Get the correct sub-matrix based on the index
     Eigen::Matrix2d covarianceAxis;
     if (index == kRoll) {
@@ -337,20 +439,14 @@ void Visual::updateOrientation(const Eigen::Matrix6d& covariance, ShapeIndex ind
     computeShapeScaleAndOrientation2D(covarianceAxis, shape_scale, shape_orientation, XZ_PLANE);
     // Give a minimal height for the cylinder for better visualization
     shape_scale.y = 0.001;
-    // Store the computed scale to be used if the user change the scale
-    current_ori_scale_[index] = shape_scale;
-    // Apply the current scale factor
-    shape_scale.x *= current_ori_scale_factor_;
-    shape_scale.z *= current_ori_scale_factor_;
-    // The computed scale is equivalent to twice the standard deviation _in radians_.
-    // So we need to convert it to the linear scale of the shape using tan().
-    // Also, we bound the maximum std.
-    radianScaleToMetricScaleBounded(shape_scale.x, max_degrees);
-    radianScaleToMetricScaleBounded(shape_scale.z, max_degrees);
   }
+}
 
-  // Rotate and scale the scene node of the orientation part
-  orientation_shape_[index]->setOrientation(shape_orientation);
+void Visual::updateOrientationScale(ShapeIndex index) {
+  // Recover the last computed scale and apply the current scale factor
+  const Ogre::Vector3 shape_scale = getOrientationMetricScale(index, current_ori_scale_[index], current_ori_scale_factor_);
+
+  // Apply the new scale
   if (!shape_scale.isNaN())
     orientation_shape_[index]->setScale(shape_scale);
   else
@@ -372,19 +468,8 @@ void Visual::setPositionScale(float pos_scale) {
 void Visual::setOrientationOffset(float ori_offset) {
   // Scale the orientation root node to position the shapes along the axis
   orientation_root_node_->setScale(ori_offset, ori_offset, ori_offset);
-  // The scale the offset_nodes as well so the displayed shape represents a 1-sigma
-  // standard deviation when displayed with an scale of 1.0
-  // NOTE: We only want to change the scales of the dimentions that represent the
-  //       orientation covariance. The other dimensions are set to 1.0.
-  for (int i = 0; i < kNumOriShapes; i++) {
-    if (i == kYaw2D) {
-      // For 2D, the angle is only encoded on x, but we also scale on y to put the top of the cone at the pose origin
-      orientation_offset_node_[i]->setScale(ori_offset, ori_offset, 1.0);
-    } else {
-      // For 3D, the angle covariance is encoded on x and z dimensions
-      orientation_offset_node_[i]->setScale(ori_offset, 1.0, ori_offset);
-    }
-  }
+  for (int i = 0; i < kNumOriShapes; i++)
+    orientation_offset_node_[i]->setScale(getOrientationOffsetScale(static_cast<ShapeIndex>(i), ori_offset));
 }
 
 void Visual::setOrientationScale(float ori_scale) {
@@ -392,27 +477,8 @@ void Visual::setOrientationScale(float ori_scale) {
   // convert it to meters and apply to the shape scale. Note we have different invariant
   // scales in the 3D and in 2D.
   current_ori_scale_factor_ = ori_scale;
-  for (int i = 0; i < kNumOriShapes; i++) {
-    // Recover the last computed scale
-    Ogre::Vector3 shape_scale = current_ori_scale_[i];
-    if (i == kYaw2D) {
-      // Changes in scale in 2D only affects the x dimension
-      // Apply the current scale factor
-      shape_scale.x *= current_ori_scale_factor_;
-      // Convert from radians to meters
-      radianScaleToMetricScaleBounded(shape_scale.x, max_degrees);
-    } else {
-      // Changes in scale in 3D only affects the x and z dimensions
-      // Apply the current scale factor
-      shape_scale.x *= current_ori_scale_factor_;
-      shape_scale.z *= current_ori_scale_factor_;
-      // Convert from radians to meters
-      radianScaleToMetricScaleBounded(shape_scale.x, max_degrees);
-      radianScaleToMetricScaleBounded(shape_scale.z, max_degrees);
-    }
-    // Apply the new scale
-    orientation_shape_[i]->setScale(shape_scale);
-  }
+  for (int i = 0; i < kNumOriShapes; i++)
+    updateOrientationScale(static_cast<ShapeIndex>(i));
 }
 
 void Visual::setPositionColor(const Ogre::ColourValue& c) {
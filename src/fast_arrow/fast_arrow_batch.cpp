@@ -0,0 +1,347 @@
+#include "fast_arrow/fast_arrow_batch.h"
+
+#include <OgreSceneManager.h>
+#include <OgreSceneNode.h>
+#include <OgreManualObject.h>
+#include <OgreMaterialManager.h>
+#include <OgreTechnique.h>
+#include <OgreHardwareVertexBuffer.h>
+#include <OgreVertexIndexData.h>
+
+#include <algorithm>
+#include <string>
+
+namespace rviz
+{
+
+int FastArrowBatch::batch_idx = 0;
+
+FastArrowBatch::FastArrowBatch(Ogre::SceneManager* scene_manager,
+                               Ogre::SceneNode* parent_node,
+                               float shaft_length,
+                               float head_length,
+                               float head_diameter)
+  : scene_manager_(scene_manager)
+  , rebuild_(false)
+  , n_transparent_(0)
+  , color_(Ogre::ColourValue::White)
+  , shaft_length_(shaft_length)
+  , head_length_(head_length)
+  , head_diameter_(head_diameter)
+  , heads_visible_(true)
+{
+  if (!parent_node)
+  {
+    parent_node = scene_manager_->getRootSceneNode();
+  }
+
+  const std::string name = "fast_arrow_batch" + std::to_string(batch_idx++);
+  scene_node_ = parent_node->createChildSceneNode();
+
+  manual_object_ = scene_manager_->createManualObject(name);
+  manual_object_->setDynamic(true);
+  scene_node_->attachObject(manual_object_);
+
+  // unlit, the lines have the colors of their vertices
+  material_ = Ogre::MaterialManager::getSingleton().create(name + "_material", Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+  material_->setReceiveShadows(false);
+  material_->setLightingEnabled(false);
+  bounding_box_.setNull();
+}
+
+FastArrowBatch::~FastArrowBatch()
+{
+  scene_manager_->destroyManualObject(manual_object_);
+  Ogre::MaterialManager::getSingleton().remove(material_->getName());
+  scene_manager_->destroySceneNode(scene_node_->getName());
+}
+
+size_t FastArrowBatch::add()
+{
+  arrows_.push_back(Arrow{Ogre::Vector3::ZERO, Ogre::Quaternion::IDENTITY, color_, false});
+  if (color_.a < 0.9998)
+  {
+    n_transparent_++;
+    updateTransparency();
+  }
+  rebuild_ = true;
+  return arrows_.size() - 1;
+}
+
+void FastArrowBatch::resize(size_t size)
+{
+  if (size == arrows_.size())
+  {
+    return;
+  }
+
+  while (arrows_.size() > size)
+  {
+    if (arrows_.back().color.a < 0.9998)
+    {
+      n_transparent_--;
+    }
+    arrows_.pop_back();
+  }
+  while (arrows_.size() < size)
+  {
+    add();
+  }
+  updateTransparency();
+
+  // the dirty arrows may have been removed
+  dirty_arrows_.erase(std::remove_if(dirty_arrows_.begin(), dirty_arrows_.end(), [size](size_t index) { return index >= size; }), dirty_arrows_.end());
+  rebuild_ = true;
+}
+
+void FastArrowBatch::clear()
+{
+  arrows_.clear();
+  dirty_arrows_.clear();
+  n_transparent_ = 0;
+  rebuild_ = true;
+}
+
+size_t FastArrowBatch::size() const
+{
+  return arrows_.size();
+}
+
+void FastArrowBatch::set(float shaft_length, float head_length, float head_diameter)
+{
+  shaft_length_ = shaft_length;
+  head_length_ = head_length;
+  head_diameter_ = head_diameter;
+  rebuild_ = true;
+}
+
+void FastArrowBatch::setHeadsVisible(bool visible)
+{
+  if (heads_visible_ == visible)
+  {
+    return;
+  }
+  heads_visible_ = visible;
+  rebuild_ = true;
+}
+
+void FastArrowBatch::setColor(float r, float g, float b, float a)
+{
+  setColor(Ogre::ColourValue(r, g, b, a));
+}
+
+void FastArrowBatch::setColor(const Ogre::ColourValue& color)
+{
+  color_ = color;
+  for (auto& arrow : arrows_)
+  {
+    arrow.color = color;
+  }
+  n_transparent_ = color.a < 0.9998 ? arrows_.size() : 0;
+  updateTransparency();
+  rebuild_ = true;
+}
+
+void FastArrowBatch::setColor(size_t index, const Ogre::ColourValue& color)
+{
+  Arrow& arrow = arrows_.at(index);
+  if (arrow.color.a < 0.9998)
+  {
+    n_transparent_--;
+  }
+  if (color.a < 0.9998)
+  {
+    n_transparent_++;
+  }
+  arrow.color = color;
+  updateTransparency();
+  markDirty(index);
+}
+
+void FastArrowBatch::setPosition(size_t index, const Ogre::Vector3& position)
+{
+  arrows_.at(index).position = position;
+  markDirty(index);
+}
+
+void FastArrowBatch::setOrientation(size_t index, const Ogre::Quaternion& orientation)
+{
+  arrows_.at(index).orientation = orientation;
+  markDirty(index);
+}
+
+void FastArrowBatch::setDirection(size_t index, const Ogre::Vector3& direction)
+{
+  if (!direction.isZeroLength())
+  {
+    setOrientation(index, Ogre::Vector3::NEGATIVE_UNIT_Z.getRotationTo(direction));
+  }
+}
+
+void FastArrowBatch::setUserData(const Ogre::Any& data)
+{
+  manual_object_->getUserObjectBindings().setUserAny(data);
+}
+
+void FastArrowBatch::markDirty(size_t index)
+{
+  Arrow& arrow = arrows_[index];
+  if (!arrow.dirty)
+  {
+    arrow.dirty = true;
+    dirty_arrows_.push_back(index);
+  }
+}
+
+size_t FastArrowBatch::verticesPerArrow() const
+{
+  return heads_visible_ ? max_vertices_per_arrow : 2;
+}
+
+void FastArrowBatch::getVertices(const Arrow& arrow, Ogre::Vector3 (&vertices)[max_vertices_per_arrow]) const
+{
+  // The same lines as the ones of FastArrow, its identity orientation points along the negative z axis
+  const Ogre::Vector3 tail = arrow.position;
+  const Ogre::Vector3 tip = arrow.position + arrow.orientation * Ogre::Vector3(0, 0, -shaft_length_);
+  const Ogre::Vector3 head_l = arrow.position + arrow.orientation * Ogre::Vector3(0, head_diameter_ / 2, head_length_ - shaft_length_);
+  const Ogre::Vector3 head_r = arrow.position + arrow.orientation * Ogre::Vector3(0, -head_diameter_ / 2, head_length_ - shaft_length_);
+
+  vertices[0] = tail;
+  vertices[1] = tip;
+  vertices[2] = tip;
+  vertices[3] = head_l;
+  vertices[4] = tip;
+  vertices[5] = head_r;
+}
+
+void FastArrowBatch::updateTransparency()
+{
+  // Same as rviz::Shape::setColor()
+  if (n_transparent_ > 0)
+  {
+    material_->getTechnique(0)->setSceneBlending(Ogre::SBT_TRANSPARENT_ALPHA);
+    material_->getTechnique(0)->setDepthWriteEnabled(false);
+  }
+  else
+  {
+    material_->getTechnique(0)->setSceneBlending(Ogre::SBT_REPLACE);
+    material_->getTechnique(0)->setDepthWriteEnabled(true);
+  }
+}
+
+void FastArrowBatch::update()
+{
+  if (rebuild_ || dirty_arrows_.size() > max_dirty_fraction * arrows_.size())
+  {
+    rebuild();
+  }
+  else if (!dirty_arrows_.empty())
+  {
+    rewriteDirty();
+  }
+
+  for (const size_t index : dirty_arrows_)
+  {
+    arrows_[index].dirty = false;
+  }
+  dirty_arrows_.clear();
+  rebuild_ = false;
+}
+
+void FastArrowBatch::rebuild()
+{
+  bounding_box_.setNull();
+  if (arrows_.empty())
+  {
+    manual_object_->clear();
+    return;
+  }
+
+  // the section is reused as long as the arrows fit in its buffer
+  if (manual_object_->getNumSections() == 0)
+  {
+    manual_object_->estimateVertexCount(arrows_.size() * verticesPerArrow());
+    manual_object_->begin(material_->getName(), Ogre::RenderOperation::OT_LINE_LIST);
+  }
+  else
+  {
+    manual_object_->beginUpdate(0);
+  }
+
+  Ogre::Vector3 vertices[max_vertices_per_arrow];
+  for (const auto& arrow : arrows_)
+  {
+    getVertices(arrow, vertices);
+    for (size_t it = 0; it < verticesPerArrow(); it++)
+    {
+      manual_object_->position(vertices[it]);
+      manual_object_->colour(arrow.color);
+      bounding_box_.merge(vertices[it]);
+    }
+  }
+  manual_object_->end();
+  manual_object_->setBoundingBox(bounding_box_);
+}
+
+void FastArrowBatch::rewriteDirty()
+{
+  // Only the vertices of the modified arrows are written to the buffer, grouped into contiguous
+  // ranges so that arrows modified together are uploaded by a single write
+  std::sort(dirty_arrows_.begin(), dirty_arrows_.end());
+  std::vector<unsigned char> staging;
+  size_t first = dirty_arrows_.front();
+  size_t last = first;
+  for (const size_t index : dirty_arrows_)
+  {
+    if (index > last + max_rewrite_gap + 1)
+    {
+      writeRange(first, last, staging);
+      first = index;
+    }
+    last = index;
+  }
+  writeRange(first, last, staging);
+
+  // the box only grows until the next rebuild, which is enough for culling and selection
+  manual_object_->setBoundingBox(bounding_box_);
+  scene_node_->needUpdate();
+}
+
+void FastArrowBatch::writeRange(size_t first, size_t last, std::vector<unsigned char>& staging)
+{
+  Ogre::VertexData* vertex_data = manual_object_->getSection(0)->getRenderOperation()->vertexData;
+  const Ogre::VertexElement* position_element = vertex_data->vertexDeclaration->findElementBySemantic(Ogre::VES_POSITION);
+  const Ogre::VertexElement* colour_element = vertex_data->vertexDeclaration->findElementBySemantic(Ogre::VES_DIFFUSE);
+  Ogre::HardwareVertexBufferSharedPtr buffer = vertex_data->vertexBufferBinding->getBuffer(position_element->getSource());
+  const size_t vertex_size = buffer->getVertexSize();
+
+  // the clean arrows inside the range are written unchanged from their stored poses
+  const size_t n_vertices = verticesPerArrow();
+  staging.resize((last - first + 1) * n_vertices * vertex_size);
+  unsigned char* vertex = staging.data();
+  Ogre::Vector3 vertices[max_vertices_per_arrow];
+  for (size_t index = first; index <= last; index++)
+  {
+    const Arrow& arrow = arrows_[index];
+    const Ogre::uint32 colour = Ogre::VertexElement::convertColourValue(arrow.color, colour_element->getType());
+    getVertices(arrow, vertices);
+    for (size_t it = 0; it < n_vertices; it++, vertex += vertex_size)
+    {
+      float* position;
+      position_element->baseVertexPointerToElement(vertex, &position);
+      position[0] = vertices[it].x;
+      position[1] = vertices[it].y;
+      position[2] = vertices[it].z;
+      Ogre::uint32* packed_colour;
+      colour_element->baseVertexPointerToElement(vertex, &packed_colour);
+      *packed_colour = colour;
+      if (arrow.dirty)
+      {
+        bounding_box_.merge(vertices[it]);
+      }
+    }
+  }
+  buffer->writeData((vertex_data->vertexStart + first * n_vertices) * vertex_size, staging.size(), staging.data());
+}
+
+} // namespace rviz
@@ -1,4 +1,5 @@
 #include <OGRE/OgreEntity.h>
+#include <OGRE/OgreManualObject.h>
 #include <OGRE/OgreSceneNode.h>
 
 #include <rviz/display_context.h>
@@ -15,8 +16,8 @@
 #include <rviz/properties/string_property.h>
 #include <rviz/properties/vector_property.h>
 #include <rviz/selection/selection_manager.h>
-#include <rviz/validate_floats.h>
-#include <rviz/validate_quaternions.h>
+#include <rviz/view_controller.h>
+#include <rviz/view_manager.h>
 
 #include <pose_with_covariance_array/display.h>
 
@@ -26,6 +27,8 @@
 
 #include <Eigen/Dense>
 
+#include <algorithm>
+
 namespace mrs_rviz_plugins
 {
 
@@ -44,67 +47,101 @@ public:
     rviz::Property* tmp = new rviz::StringProperty("frame ID", (message_->header.frame_id).c_str(), "name of the frame", root);
     tmp->setReadOnly(true);
 
-    for (const auto& cur_pose : message_->poses)
-    {
-      rviz::Property* sub_root = new rviz::Property(("PoseWithCovariance " + std::to_string(cur_pose.id)).c_str(), QVariant(), "position and orientation with covariance", root);
-      
-      tmp = new rviz::IntProperty("ID", cur_pose.id, "ID", sub_root);
+    // only the poses of the current page get their properties
+    const auto message = message_;
+    pages_.create(root, message->size(), display_, SLOT(updateSelectionPage()), [message](size_t index, rviz::Property* parent) {
+      const auto      id          = message->ids[index];
+      const double*   position    = message->position(index);
+      const double*   orientation = message->orientation(index);
+      rviz::Property* sub_root    = new rviz::Property(("PoseWithCovariance " + std::to_string(id)).c_str(), QVariant(), "position and orientation with covariance", parent);
+
+      rviz::Property* tmp = new rviz::IntProperty("ID", id, "ID", sub_root);
       tmp->setReadOnly(true);
-      tmp = new rviz::VectorProperty("position", Ogre::Vector3(cur_pose.pose.position.x, cur_pose.pose.position.y, cur_pose.pose.position.z), "position", sub_root);
+      tmp = new rviz::VectorProperty("position", Ogre::Vector3(position[0], position[1], position[2]), "position", sub_root);
       tmp->setReadOnly(true);
-      tmp = new rviz::QuaternionProperty("orientation", Ogre::Quaternion(cur_pose.pose.orientation.w, cur_pose.pose.orientation.x, cur_pose.pose.orientation.y, cur_pose.pose.orientation.z), "orientation", sub_root);
+      tmp = new rviz::QuaternionProperty("orientation", Ogre::Quaternion(orientation[3], orientation[0], orientation[1], orientation[2]), "orientation", sub_root);
       tmp->setReadOnly(true);
-    }
+      return sub_root;
+    });
     root_->setParent(parent_property);
   }
 
+  void destroyProperties(const rviz::Picked& obj, rviz::Property* parent_property) {
+    pages_.reset();
+    SelectionHandler::destroyProperties(obj, parent_property);
+  }
+
+  void updatePage() {
+    pages_.updatePage();
+  }
+
   void getAABBs([[maybe_unused]] const rviz::Picked& obj, rviz::V_AABB& aabbs) {
 
-    for (const auto& cur_pose : display_->disp_data)
-    {
-      if (display_->pose_valid_) {
-        if (display_->shape_property_->getOptionInt() == Display::Arrow) {
-          aabbs.push_back(cur_pose.arrow_->getHead()->getEntity()->getWorldBoundingBox());
-          aabbs.push_back(cur_pose.arrow_->getShaft()->getEntity()->getWorldBoundingBox());
-        } else if (display_->shape_property_->getOptionInt() == Display::Axes) {
-          aabbs.push_back(cur_pose.axes_->getXShape()->getEntity()->getWorldBoundingBox());
-          aabbs.push_back(cur_pose.axes_->getYShape()->getEntity()->getWorldBoundingBox());
-          aabbs.push_back(cur_pose.axes_->getZShape()->getEntity()->getWorldBoundingBox());
-        }
-        /* else { */
-        /*   aabbs.push_back(cur_pose.fast_arrow_->getShaft()->getEntity()->getWorldBoundingBox()); */
-        /*   aabbs.push_back(cur_pose.fast_arrow_->getHeadL()->getEntity()->getWorldBoundingBox()); */
-        /*   aabbs.push_back(cur_pose.fast_arrow_->getHeadR()->getEntity()->getWorldBoundingBox()); */
-        /* } */
-
-        if (display_->covariance_property_->getBool()) {
-          if (display_->covariance_property_->getPositionBool()) {
-            aabbs.push_back(cur_pose.covariance_->getPositionShape()->getEntity()->getWorldBoundingBox());
-          }
-          if (display_->covariance_property_->getOrientationBool()) {
-            aabbs.push_back(
-                cur_pose.covariance_->getOrientationShape(mrs_rviz_plugins::covariance::Visual::kRoll)->getEntity()->getWorldBoundingBox());
-            aabbs.push_back(
-                cur_pose.covariance_->getOrientationShape(mrs_rviz_plugins::covariance::Visual::kPitch)->getEntity()->getWorldBoundingBox());
-            aabbs.push_back(
-                cur_pose.covariance_->getOrientationShape(mrs_rviz_plugins::covariance::Visual::kYaw)->getEntity()->getWorldBoundingBox());
-          }
-        }
-      }
+    // all the covariances are in the same two meshes
+    if (display_->pose_valid_ && display_->covariance_property_->getBool()) {
+      if (display_->covariance_property_->getPositionBool())
+        aabbs.push_back(display_->covariance_batch_->getPositionObject()->getWorldBoundingBox());
+      if (display_->covariance_property_->getOrientationBool())
+        aabbs.push_back(display_->covariance_batch_->getOrientationObject()->getWorldBoundingBox());
+    }
+
+    // all the fast arrows are in a single line list
+    const int shape = display_->shape_property_->getOptionInt();
+    if (display_->pose_valid_ && (display_->accumulate_property_->getBool() || shape == Display::FastArrow || shape == Display::Glyphs))
+      aabbs.push_back(display_->fast_arrows_->getManualObject()->getWorldBoundingBox());
+
+    // the boxes of the arrows or axes are only collected once per message or change of the shape,
+    // the highlight then consists of a bounded number of boxes each enclosing a group of poses
+    if (display_->pose_valid_ && !display_->accumulate_property_->getBool() && (shape == Display::Arrow || shape == Display::Axes)) {
+      if (boxes_dirty_ || shape != boxes_shape_)
+        buildBoxes(shape);
+      boxes_.collectBoxes(max_highlight_boxes, aabbs);
     }
   }
 
-  void setMessage(const mrs_msgs::PoseWithCovarianceArrayStampedConstPtr& message)
+  void setMessage(const FlatPoseWithCovarianceArrayStamped::ConstPtr& message)
   {
     message_ = message;
     tracked_objects_.clear();
+    invalidateBoxes();
     /* updateProperties(); */
   }
 
+  void invalidateBoxes() {
+    boxes_dirty_ = true;
+  }
+
 private:
   std::unique_ptr<rviz::Property> root_;
-  mrs_msgs::PoseWithCovarianceArrayStampedConstPtr message_;
+  FlatPoseWithCovarianceArrayStamped::ConstPtr message_;
+  // the boxes are derived from the nodes here, the cached world boxes still hold the poses of the last frame
+  void buildBoxes(int shape) {
+    std::vector<Ogre::AxisAlignedBox> pose_boxes;
+    pose_boxes.reserve(display_->disp_data.size());
+    for (const auto& cur_pose : display_->disp_data) {
+      Ogre::AxisAlignedBox box;
+      if (shape == Display::Arrow && cur_pose.arrow_) {
+        box.merge(cur_pose.arrow_->getHead()->getEntity()->getWorldBoundingBox(true));
+        box.merge(cur_pose.arrow_->getShaft()->getEntity()->getWorldBoundingBox(true));
+      } else if (shape == Display::Axes && cur_pose.axes_) {
+        box.merge(cur_pose.axes_->getXShape()->getEntity()->getWorldBoundingBox(true));
+        box.merge(cur_pose.axes_->getYShape()->getEntity()->getWorldBoundingBox(true));
+        box.merge(cur_pose.axes_->getZShape()->getEntity()->getWorldBoundingBox(true));
+      }
+      pose_boxes.push_back(box);
+    }
+    boxes_.build(pose_boxes);
+    boxes_shape_ = shape;
+    boxes_dirty_ = false;
+  }
+
+  static constexpr size_t max_highlight_boxes = 64;
+
   Display* display_;
+  selection::PagedProperties pages_;
+  selection::AabbTree boxes_;
+  bool boxes_dirty_ = true;
+  int boxes_shape_ = -1;
 };
 
 Display::Display() : pose_valid_(false) {
@@ -112,6 +149,8 @@ Display::Display() : pose_valid_(false) {
   shape_property_->addOption("Arrow", Arrow);
   shape_property_->addOption("Axes", Axes);
   shape_property_->addOption("FastArrow", FastArrow);
+  // for arrays of many thousands of poses, each pose is a single line along its heading
+  shape_property_->addOption("Glyphs", Glyphs);
 
   color_property_ = std::make_unique<rviz::ColorProperty>("Color", QColor(255, 25, 0), "Color to draw the arrow.", this, SLOT(updateColorAndAlpha()));
 
@@ -135,6 +174,35 @@ Display::Display() : pose_valid_(false) {
 
   covariance_property_ =
       std::make_unique<covariance::Property>("Covariance", true, "Whether or not the covariances of the messages should be shown.", this, SLOT(queueRender()));
+
+  downsampling_property_ = std::make_unique<rviz::EnumProperty>("Downsampling", "None", "Show only a subset of the poses of large messages, applied to the next message.",
+                                                                this, SLOT(updateDownsampling()));
+  downsampling_property_->addOption("None", Downsampling::None);
+  downsampling_property_->addOption("Voxel Grid", Downsampling::VoxelGrid);
+  downsampling_property_->addOption("Every Nth", Downsampling::EveryNth);
+  downsampling_property_->addOption("Max Count", Downsampling::MaxCount);
+
+  voxel_size_property_ = std::make_unique<rviz::FloatProperty>("Voxel Size", 0.5, "Only the first pose in each voxel of this size is shown, in meters.",
+                                                               downsampling_property_.get(), SLOT(updateDownsampling()), this);
+  voxel_size_property_->setMin(0.001);
+
+  step_property_ = std::make_unique<rviz::IntProperty>("Step", 10, "Only every n-th pose of the message is shown.", downsampling_property_.get(),
+                                                       SLOT(updateDownsampling()), this);
+  step_property_->setMin(1);
+
+  max_count_property_ = std::make_unique<rviz::IntProperty>("Max Count", 1000, "At most this number of poses is shown, the same ones for the same message.",
+                                                            downsampling_property_.get(), SLOT(updateDownsampling()), this);
+  max_count_property_->setMin(0);
+
+  updateDownsampling();
+
+  accumulate_property_ = std::make_unique<rviz::BoolProperty>(
+      "Accumulate", false, "Keep the poses of the past messages, they are drawn as fast arrows or glyphs. The covariances are shown for the last message only.", this,
+      SLOT(updateAccumulation()));
+
+  history_size_property_ = std::make_unique<rviz::IntProperty>("History Size", 10000, "Number of the accumulated poses, the oldest ones are replaced by the new ones.",
+                                                               accumulate_property_.get(), SLOT(updateAccumulation()), this);
+  history_size_property_->setMin(1);
 }
 
 void Display::onInitialize() {
@@ -153,14 +221,12 @@ void Display::onInitialize() {
     d.arrow_->setColor(color);
 
     d.axes_ = boost::make_shared<rviz::Axes>(scene_manager_, scene_node_, axes_length_property_->getFloat(), axes_radius_property_->getFloat());
-
-    d.fast_arrow_ = boost::make_shared<rviz::FastArrow>(scene_manager_, scene_node_, shaft_length_property_->getFloat(), head_length_property_->getFloat(),
-                                        head_radius_property_->getFloat());
-    d.fast_arrow_->setColor(color);
-
-    d.covariance_ = covariance_property_->createAndPushBackVisual(scene_manager_, scene_node_);
-
   }
+  fast_arrows_ = boost::make_shared<rviz::FastArrowBatch>(scene_manager_, scene_node_, shaft_length_property_->getFloat(), head_length_property_->getFloat(),
+                                                          head_radius_property_->getFloat());
+  covariance_batch_ = covariance_property_->createBatchVisual(scene_manager_, scene_node_);
+  covariance_batch_->setShapeCache(&covariance_cache_);
+  updateAccumulation();
   updateShapeChoice();
   updateColorAndAlpha();
 }
@@ -181,41 +247,53 @@ void Display::updateColorAndAlpha() {
   color.a                 = alpha_property_->getFloat();
 
   for (auto& d : disp_data) {
-    d.arrow_->setColor(color);
-    d.fast_arrow_->setColor(color);
+    if (d.arrow_)
+      d.arrow_->setColor(color);
   }
+  fast_arrows_->setColor(color);
+  fast_arrows_->update();
 
   context_->queueRender();
 }
 
 void Display::updateArrowGeometry() {
   for (auto& d : disp_data) {
-    d.arrow_->set(shaft_length_property_->getFloat(), shaft_radius_property_->getFloat(), head_length_property_->getFloat(), head_radius_property_->getFloat());
-    d.fast_arrow_->set(shaft_length_property_->getFloat(), head_length_property_->getFloat(), head_radius_property_->getFloat());
+    if (d.arrow_)
+      d.arrow_->set(shaft_length_property_->getFloat(), shaft_radius_property_->getFloat(), head_length_property_->getFloat(), head_radius_property_->getFloat());
   }
+  fast_arrows_->set(shaft_length_property_->getFloat(), head_length_property_->getFloat(), head_radius_property_->getFloat());
+  fast_arrows_->update();
+  coll_handler_->invalidateBoxes();
   context_->queueRender();
 }
 
 void Display::updateAxisGeometry() {
   for (auto& d : disp_data) {
-    d.axes_->set(axes_length_property_->getFloat(), axes_radius_property_->getFloat());
+    if (d.axes_)
+      d.axes_->set(axes_length_property_->getFloat(), axes_radius_property_->getFloat());
   }
+  coll_handler_->invalidateBoxes();
   context_->queueRender();
 }
 
 void Display::updateShapeChoice() {
-  bool use_mesh_arrow = (shape_property_->getOptionInt() == FastArrow);
-  bool use_arrow = use_mesh_arrow || (shape_property_->getOptionInt() == FastArrow);
-
-  color_property_->setHidden(!use_arrow);
-  alpha_property_->setHidden(!use_arrow);
-  shaft_length_property_->setHidden(!use_arrow);
+  const int  shape          = shape_property_->getOptionInt();
+  const bool use_mesh_arrow = (shape == Arrow);
+  const bool use_arrow      = use_mesh_arrow || (shape == FastArrow);
+  const bool use_lines      = use_arrow || (shape == Glyphs);
+
+  color_property_->setHidden(!use_lines);
+  alpha_property_->setHidden(!use_lines);
+  shaft_length_property_->setHidden(!use_lines);
   shaft_radius_property_->setHidden(!use_mesh_arrow);
   head_length_property_->setHidden(!use_arrow);
   head_radius_property_->setHidden(!use_arrow);
 
-  axes_length_property_->setHidden(use_arrow);
-  axes_radius_property_->setHidden(use_arrow);
+  axes_length_property_->setHidden(shape != Axes);
+  axes_radius_property_->setHidden(shape != Axes);
+
+  fast_arrows_->setHeadsVisible(shape != Glyphs);
+  fast_arrows_->update();
 
   updateShapeVisibility();
 
@@ -229,12 +307,11 @@ void Display::updateShapeVisibility() {
         d.arrow_->getSceneNode()->setVisible(false);
       if (d.axes_)
         d.axes_->getSceneNode()->setVisible(false);
-      if (d.fast_arrow_)
-        d.fast_arrow_->getSceneNode()->setVisible(false);
-
-      if (d.covariance_)
-        d.covariance_->setVisible(false);
     }
+    if (fast_arrows_)
+      fast_arrows_->getSceneNode()->setVisible(false);
+    if (covariance_batch_)
+      covariance_batch_->setVisible(false);
   } else {
     /* bool use_arrow = (shape_property_->getOptionInt() == Arrow); */
     for (auto& d : disp_data) {
@@ -244,120 +321,191 @@ void Display::updateShapeVisibility() {
             d.arrow_->getSceneNode()->setVisible(true);
           if (d.axes_)
             d.axes_->getSceneNode()->setVisible(false);
-          if (d.fast_arrow_)
-            d.fast_arrow_->getSceneNode()->setVisible(false);
           break;
         case (Axes):
           if (d.arrow_)
             d.arrow_->getSceneNode()->setVisible(false);
           if (d.axes_)
             d.axes_->getSceneNode()->setVisible(true);
-          if (d.fast_arrow_)
-            d.fast_arrow_->getSceneNode()->setVisible(false);
           break;
         default:
           if (d.arrow_)
             d.arrow_->getSceneNode()->setVisible(false);
           if (d.axes_)
             d.axes_->getSceneNode()->setVisible(false);
-          if (d.fast_arrow_)
-            d.fast_arrow_->getSceneNode()->setVisible(true);
       }
     }
+    fast_arrows_->getSceneNode()->setVisible(accumulate_property_->getBool() || shape_property_->getOptionInt() == FastArrow ||
+                                             shape_property_->getOptionInt() == Glyphs);
     covariance_property_->updateVisibility();
   }
 }
 
 //}
 
-void Display::processMessage(const mrs_msgs::PoseWithCovarianceArrayStamped::ConstPtr& message) {
-  disp_data.clear();
-  while (covariance_property_->sizeVisual() > 0) {
-    covariance_property_->popFrontVisual();
-  }
+void Display::processMessage(const FlatPoseWithCovarianceArrayStamped::ConstPtr& message) {
+  // The objects of the previous message are reused, only the missing ones are created and the extra ones destroyed.
+  // Only the objects of the current shape are kept.
+  // In the accumulate mode, all the poses are drawn as fast arrows or glyphs
+  const int  shape      = shape_property_->getOptionInt();
+  const bool accumulate = accumulate_property_->getBool();
+  const bool use_batch  = accumulate || shape == FastArrow || shape == Glyphs;
+  covariance_batch_->clear();
 
   coll_handler_->setMessage(message);
-  for (int i = 0; i < (int)(message->poses.size()); i++) {
-    if (!rviz::validateFloats(message->poses[i].pose) || !rviz::validateFloats(message->poses[i].covariance)) {
-      setStatus(rviz::StatusProperty::Error, "Topic", "Message contained invalid floating point values (nans or infs)");
-      return;
-    }
+  coll_handler_->addTrackedObjects(fast_arrows_->getSceneNode());
+  coll_handler_->addTrackedObjects(covariance_batch_->getSceneNode());
+
+  // The shapes of the covariances are computed by the batch visual once they are visible,
+  // covariances repeated from the previous messages are taken from the cache.
+  covariance_cache_.resetCounters();
+
+  // All the poses share the header, so the transform to the fixed frame is looked up only once and applied to all of them
+  Ogre::Vector3    frame_position;
+  Ogre::Quaternion frame_orientation;
+  if (!context_->getFrameManager()->getTransform(message->header, frame_position, frame_orientation)) {
+    ROS_ERROR("Error transforming poses '%s' from frame '%s' to frame '%s'", qPrintable(getName()), message->header.frame_id.c_str(), qPrintable(fixed_frame_));
+    disp_data.clear();
+    // the accumulated poses stay
+    if (!accumulate)
+      fast_arrows_->resize(0);
+    fast_arrows_->update();
+    return;
+  }
 
-    if (!rviz::validateQuaternions(message->poses[i].pose)) {
-      ROS_WARN_ONCE_NAMED("quaternions",
-                          "PoseWithCovariance '%s' contains unnormalized quaternions. "
-                          "This warning will only be output once but may be true for others; "
-                          "enable DEBUG messages for ros.rviz.quaternions to see more details.",
-                          qPrintable(getName()));
-      ROS_DEBUG_NAMED("quaternions", "PoseWithCovariance '%s' contains unnormalized quaternions.", qPrintable(getName()));
-    }
+  // Validating and transforming the poses does not touch Ogre, it is done in parallel for large messages
+  // and the loop below only applies the results to the visuals
+  prepared_.prepare(*message, frame_position, frame_orientation);
+  const std::vector<Ogre::Vector3>&    positions    = prepared_.getPositions();
+  const std::vector<Ogre::Quaternion>& orientations = prepared_.getOrientations();
+  const size_t                         n_valid      = prepared_.getValidCount();
+
+  if (n_valid < message->size())
+    setStatus(rviz::StatusProperty::Error, "Topic", "Message contained invalid floating point values (nans or infs)");
+
+  if (prepared_.hasUnnormalized()) {
+    ROS_WARN_ONCE_NAMED("quaternions",
+                        "PoseWithCovariance '%s' contains unnormalized quaternions. "
+                        "This warning will only be output once but may be true for others; "
+                        "enable DEBUG messages for ros.rviz.quaternions to see more details.",
+                        qPrintable(getName()));
+    ROS_DEBUG_NAMED("quaternions", "PoseWithCovariance '%s' contains unnormalized quaternions.", qPrintable(getName()));
+  }
 
-    Ogre::Vector3    position;
-    Ogre::Quaternion orientation;
-    if (!context_->getFrameManager()->transform(message->header, message->poses[i].pose, position, orientation)) {
-      ROS_ERROR("Error transforming pose '%s' from frame '%s' to frame '%s'", qPrintable(getName()), message->header.frame_id.c_str(),
-                qPrintable(fixed_frame_));
-      return;
-    }
+  // Only the poses left after downsampling get their objects
+  downsampling_.select(positions, n_valid, selected_);
+  setStatus(rviz::StatusProperty::Ok, "Poses", QString("%1 of %2 shown").arg(selected_.size()).arg(message->size()));
+  disp_data.resize(use_batch ? 0 : selected_.size());
+  if (accumulate)
+    // only grows until the history is full, then the arrows of the oldest poses are rewritten in place
+    fast_arrows_->resize(std::min(history_.capacity(), history_.size() + selected_.size()));
+  else
+    fast_arrows_->resize(use_batch ? selected_.size() : 0);
 
-    pose_valid_ = true;
-
-    disp_data.push_back(display_object());
-    auto& d = disp_data.back();
+  Ogre::ColourValue color = color_property_->getOgreColor();
+  color.a                 = alpha_property_->getFloat();
 
-    Ogre::ColourValue color = color_property_->getOgreColor();
-    color.a                 = alpha_property_->getFloat();
+  for (size_t i = 0; i < selected_.size(); i++) {
+    const size_t            index       = selected_[i];
+    const Ogre::Vector3&    position    = positions[index];
+    const Ogre::Quaternion& orientation = orientations[index];
 
-    switch (shape_property_->getOptionInt()){
-      case (Arrow):
-        d.arrow_ = boost::make_shared<rviz::Arrow>(scene_manager_, scene_node_, shaft_length_property_->getFloat(), shaft_radius_property_->getFloat(),
-            head_length_property_->getFloat(), head_radius_property_->getFloat());
+    pose_valid_ = true;
 
-        d.arrow_->setColor(color);
+    switch (use_batch ? FastArrow : shape){
+      case (Arrow): {
+        auto& d = disp_data[i];
+        d.axes_.reset();
+        if (!d.arrow_) {
+          d.arrow_ = boost::make_shared<rviz::Arrow>(scene_manager_, scene_node_, shaft_length_property_->getFloat(), shaft_radius_property_->getFloat(),
+              head_length_property_->getFloat(), head_radius_property_->getFloat());
+          d.arrow_->setColor(color);
+        }
 
         d.arrow_->setPosition(position);
         d.arrow_->setOrientation(orientation * Ogre::Quaternion(Ogre::Degree(-90), Ogre::Vector3::UNIT_Y));
 
         coll_handler_->addTrackedObjects(d.arrow_->getSceneNode());
         break;
-      case (Axes):
-        d.axes_ = boost::make_shared<rviz::Axes>(scene_manager_, scene_node_, axes_length_property_->getFloat(), axes_radius_property_->getFloat());
+      }
+      case (Axes): {
+        auto& d = disp_data[i];
+        d.arrow_.reset();
+        if (!d.axes_)
+          d.axes_ = boost::make_shared<rviz::Axes>(scene_manager_, scene_node_, axes_length_property_->getFloat(), axes_radius_property_->getFloat());
 
         d.axes_->setPosition(position);
         d.axes_->setOrientation(orientation);
 
         coll_handler_->addTrackedObjects(d.axes_->getSceneNode());
         break;
-      default:
-        d.fast_arrow_ = boost::make_shared<rviz::FastArrow>(scene_manager_, scene_node_, shaft_length_property_->getFloat(), head_length_property_->getFloat(),
-            head_radius_property_->getFloat());
-        d.fast_arrow_->setColor(color);
-
-
-        d.fast_arrow_->setPosition(position);
-        d.fast_arrow_->setOrientation(orientation * Ogre::Quaternion(Ogre::Degree(-90), Ogre::Vector3::UNIT_Y));
-
-        coll_handler_->addTrackedObjects(d.fast_arrow_->getSceneNode());
+      }
+      default: {
+        const size_t arrow = accumulate ? history_.push() : i;
+        fast_arrows_->setPosition(arrow, position);
+        fast_arrows_->setOrientation(arrow, orientation * Ogre::Quaternion(Ogre::Degree(-90), Ogre::Vector3::UNIT_Y));
+      }
     }
     if ( covariance_property_->getBool()){
-      geometry_msgs::PoseWithCovariance pwc;
-      pwc.covariance = message->poses[i].covariance;
-      pwc.pose       = message->poses[i].pose;
-      d.covariance_ = covariance_property_->createAndPushBackVisual(scene_manager_, scene_node_);
-      d.covariance_->setPosition(position);
-      d.covariance_->setOrientation(orientation);
-      d.covariance_->setCovariance(pwc);
-      coll_handler_->addTrackedObjects(d.covariance_->getPositionSceneNode());
-      coll_handler_->addTrackedObjects(d.covariance_->getOrientationSceneNode());
+      covariance_batch_->add(position, orientation, message->position(index), message->orientation(index), message->covariance(index));
     }
 
     context_->queueRender();
   }
+
+  fast_arrows_->update();
   updateShapeVisibility();
 }
 
+void Display::updateDownsampling() {
+  const int method = downsampling_property_->getOptionInt();
+  voxel_size_property_->setHidden(method != Downsampling::VoxelGrid);
+  step_property_->setHidden(method != Downsampling::EveryNth);
+  max_count_property_->setHidden(method != Downsampling::MaxCount);
+
+  downsampling_.setMethod(static_cast<Downsampling::Method>(method));
+  downsampling_.setVoxelSize(voxel_size_property_->getFloat());
+  downsampling_.setStep(step_property_->getInt());
+  downsampling_.setMaxCount(max_count_property_->getInt());
+}
+
+void Display::updateAccumulation() {
+  const bool accumulate = accumulate_property_->getBool();
+  history_size_property_->setHidden(!accumulate);
+
+  // the history starts with the next message, the arrows shown until then are resized or rewritten by it
+  history_.setCapacity(accumulate ? history_size_property_->getInt() : 0);
+  history_.clear();
+  if (accumulate) {
+    disp_data.clear();
+  }
+
+  updateShapeVisibility();
+  context_->queueRender();
+}
+
+void Display::updateSelectionPage() {
+  coll_handler_->updatePage();
+}
+
+void Display::update(float wall_dt, float ros_dt) {
+  MFDClass::update(wall_dt, ros_dt);
+
+  rviz::ViewController* view = context_->getViewManager()->getCurrent();
+  covariance_batch_->update(view ? view->getCamera() : nullptr);
+  if (covariance_property_->getBool())
+    setStatus(rviz::StatusProperty::Ok, "Covariance cache", QString("%1 hits, %2 misses").arg(covariance_cache_.getHits()).arg(covariance_cache_.getMisses()));
+}
+
 void Display::reset() {
   MFDClass::reset();
+  covariance_cache_.clear();
+  // the accumulated poses are in the previous fixed frame
+  history_.clear();
+  if (fast_arrows_) {
+    fast_arrows_->resize(0);
+    fast_arrows_->update();
+  }
   pose_valid_ = false;
   updateShapeVisibility();
 }
@@ -0,0 +1,105 @@
+#include <pose_with_covariance_array/downsampling.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace mrs_rviz_plugins
+{
+
+namespace pose_with_covariance_array
+{
+
+namespace
+{
+
+// SplitMix64 finalizer, spreads consecutive indices uniformly
+uint64_t mixBits(uint64_t value) {
+  value += 0x9e3779b97f4a7c15ull;
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+  return value ^ (value >> 31);
+}
+
+// 21 bits per axis, the grid wraps around after about two million voxels
+uint64_t voxelKey(const Ogre::Vector3& position, double voxel_size) {
+  const uint64_t mask = (1ull << 21) - 1;
+  const uint64_t x    = static_cast<uint64_t>(static_cast<int64_t>(std::floor(position.x / voxel_size))) & mask;
+  const uint64_t y    = static_cast<uint64_t>(static_cast<int64_t>(std::floor(position.y / voxel_size))) & mask;
+  const uint64_t z    = static_cast<uint64_t>(static_cast<int64_t>(std::floor(position.z / voxel_size))) & mask;
+  return x << 42 | y << 21 | z;
+}
+
+}  // namespace
+
+Downsampling::Downsampling() : method_(None), voxel_size_(0.5), step_(10), max_count_(1000) {
+}
+
+void Downsampling::setMethod(Method method) {
+  method_ = method;
+}
+
+void Downsampling::setVoxelSize(double voxel_size) {
+  voxel_size_ = voxel_size;
+}
+
+void Downsampling::setStep(size_t step) {
+  step_ = std::max<size_t>(step, 1);
+}
+
+void Downsampling::setMaxCount(size_t max_count) {
+  max_count_ = max_count;
+}
+
+void Downsampling::select(const std::vector<Ogre::Vector3>& positions, size_t n_poses, std::vector<size_t>& indices) {
+  indices.clear();
+  switch (method_) {
+    case VoxelGrid:
+      if (voxel_size_ > 0.0) {
+        selectVoxelGrid(positions, n_poses, indices);
+        return;
+      }
+      break;
+    case EveryNth:
+      indices.reserve((n_poses + step_ - 1) / step_);
+      for (size_t it = 0; it < n_poses; it += step_)
+        indices.push_back(it);
+      return;
+    case MaxCount:
+      if (n_poses > max_count_) {
+        selectMaxCount(n_poses, indices);
+        return;
+      }
+      break;
+    default:
+      break;
+  }
+
+  indices.resize(n_poses);
+  for (size_t it = 0; it < n_poses; it++)
+    indices[it] = it;
+}
+
+void Downsampling::selectVoxelGrid(const std::vector<Ogre::Vector3>& positions, size_t n_poses, std::vector<size_t>& indices) {
+  voxels_.clear();
+  for (size_t it = 0; it < n_poses; it++) {
+    if (voxels_.insert(voxelKey(positions[it], voxel_size_)).second)
+      indices.push_back(it);
+  }
+}
+
+void Downsampling::selectMaxCount(size_t n_poses, std::vector<size_t>& indices) {
+  // the poses with the smallest hashes of their indices, shown in the order of the message
+  hashes_.resize(n_poses);
+  for (size_t it = 0; it < n_poses; it++)
+    hashes_[it] = std::make_pair(mixBits(it), it);
+  std::nth_element(hashes_.begin(), hashes_.begin() + max_count_, hashes_.end());
+
+  indices.reserve(max_count_);
+  for (size_t it = 0; it < max_count_; it++)
+    indices.push_back(hashes_[it].second);
+  std::sort(indices.begin(), indices.end());
+}
+
+}  // namespace pose_with_covariance_array
+
+}  // namespace mrs_rviz_plugins
@@ -0,0 +1,34 @@
+#include <pose_with_covariance_array/pose_history.h>
+
+namespace mrs_rviz_plugins
+{
+
+namespace pose_with_covariance_array
+{
+
+PoseHistory::PoseHistory(size_t capacity) : capacity_(capacity), next_(0), size_(0) {
+}
+
+void PoseHistory::setCapacity(size_t capacity) {
+  if (capacity == capacity_)
+    return;
+  capacity_ = capacity;
+  clear();
+}
+
+void PoseHistory::clear() {
+  next_ = 0;
+  size_ = 0;
+}
+
+size_t PoseHistory::push() {
+  const size_t slot = next_;
+  next_             = (next_ + 1) % capacity_;
+  if (size_ < capacity_)
+    size_++;
+  return slot;
+}
+
+}  // namespace pose_with_covariance_array
+
+}  // namespace mrs_rviz_plugins
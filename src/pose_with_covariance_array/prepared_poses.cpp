@@ -0,0 +1,80 @@
+#include <pose_with_covariance_array/prepared_poses.h>
+
+#include <frame_transform/frame_transform.h>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace mrs_rviz_plugins
+{
+
+namespace pose_with_covariance_array
+{
+
+namespace
+{
+
+bool allFinite(const double* values, size_t n) {
+  for (size_t it = 0; it < n; it++)
+    if (!std::isfinite(values[it]))
+      return false;
+  return true;
+}
+
+}  // namespace
+
+void PreparedPoses::prepare(const FlatPoseWithCovarianceArrayStamped& message, const Ogre::Vector3& frame_position,
+                            const Ogre::Quaternion& frame_orientation, unsigned max_threads) {
+  const size_t n_poses = message.size();
+  positions_.resize(n_poses);
+  orientations_.resize(n_poses);
+
+  if (max_threads == 0)
+    max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  const size_t n_chunks = std::max<size_t>(std::min<size_t>(max_threads, n_poses / min_poses_per_thread), 1);
+
+  // A single chunk is prepared by the calling thread without waking any worker
+  const size_t             chunk_size = (n_poses + n_chunks - 1) / n_chunks;
+  std::vector<ChunkResult> chunks(n_chunks);
+  pool_.run(n_chunks, [&](size_t chunk) {
+    const size_t begin = std::min(chunk * chunk_size, n_poses);
+    chunks[chunk]      = prepareRange(message, frame_position, frame_orientation, begin, std::min(begin + chunk_size, n_poses));
+  });
+
+  ChunkResult result{n_poses, n_poses};
+  for (const ChunkResult& chunk : chunks) {
+    result.first_invalid      = std::min(result.first_invalid, chunk.first_invalid);
+    result.first_unnormalized = std::min(result.first_unnormalized, chunk.first_unnormalized);
+  }
+
+  n_valid_      = std::min(result.first_invalid, n_poses);
+  unnormalized_ = result.first_unnormalized < n_valid_;
+}
+
+PreparedPoses::ChunkResult PreparedPoses::prepareRange(const FlatPoseWithCovarianceArrayStamped& message, const Ogre::Vector3& frame_position,
+                                                       const Ogre::Quaternion& frame_orientation, size_t first, size_t last) {
+  ChunkResult result{message.size(), message.size()};
+  for (size_t it = first; it < last; it++) {
+    const double* position = message.position(it);
+    const double* quat     = message.orientation(it);
+
+    // the poses after an invalid one are not needed
+    if (!allFinite(position, 3) || !allFinite(quat, 4) || !allFinite(message.covariance(it), 36)) {
+      result.first_invalid = it;
+      break;
+    }
+    // Same tolerance as rviz::validateQuaternions()
+    const double norm2 = quat[0] * quat[0] + quat[1] * quat[1] + quat[2] * quat[2] + quat[3] * quat[3];
+    if (result.first_unnormalized == message.size() && std::abs(norm2 - 1.0) >= 10e-3)
+      result.first_unnormalized = it;
+
+    frame_transform::applyFrameTransform(frame_position, frame_orientation, Ogre::Vector3(position[0], position[1], position[2]),
+                                         Ogre::Quaternion(quat[3], quat[0], quat[1], quat[2]), positions_[it], orientations_[it]);
+  }
+  return result;
+}
+
+}  // namespace pose_with_covariance_array
+
+}  // namespace mrs_rviz_plugins
@@ -0,0 +1,66 @@
+#include <pose_with_covariance_array/worker_pool.h>
+
+namespace mrs_rviz_plugins
+{
+
+namespace pose_with_covariance_array
+{
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  task_added_.notify_all();
+  for (auto& thread : threads_)
+    thread.join();
+}
+
+void WorkerPool::run(size_t n_tasks, const std::function<void(size_t)>& task) {
+  if (n_tasks == 0)
+    return;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (threads_.size() + 1 < n_tasks)
+    threads_.emplace_back(&WorkerPool::work, this);
+
+  task_      = &task;
+  n_tasks_   = n_tasks;
+  next_      = 0;
+  n_running_ = 0;
+  task_added_.notify_all();
+
+  while (runNext(lock)) {
+  }
+  task_done_.wait(lock, [this] { return n_running_ == 0; });
+  task_ = nullptr;
+}
+
+void WorkerPool::work() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    task_added_.wait(lock, [this] { return stop_ || (task_ && next_ < n_tasks_); });
+    if (stop_)
+      return;
+    runNext(lock);
+  }
+}
+
+bool WorkerPool::runNext(std::unique_lock<std::mutex>& lock) {
+  if (!task_ || next_ >= n_tasks_)
+    return false;
+
+  const size_t                       index = next_++;
+  const std::function<void(size_t)>& task  = *task_;
+  n_running_++;
+  lock.unlock();
+  task(index);
+  lock.lock();
+  if (--n_running_ == 0 && next_ >= n_tasks_)
+    task_done_.notify_all();
+  return true;
+}
+
+}  // namespace pose_with_covariance_array
+
+}  // namespace mrs_rviz_plugins
@@ -0,0 +1,87 @@
+#include <selection/aabb_tree.h>
+
+#include <algorithm>
+
+namespace mrs_rviz_plugins
+{
+
+namespace selection
+{
+
+void AabbTree::build(const std::vector<Ogre::AxisAlignedBox>& boxes) {
+  clear();
+  boxes_ = boxes;
+  for (uint32_t it = 0; it < boxes_.size(); it++)
+    if (!boxes_[it].isNull())
+      elements_.push_back(it);
+  if (elements_.empty())
+    return;
+
+  // a binary tree with leaves of at least one element has less than twice as many nodes as elements
+  nodes_.reserve(2 * elements_.size());
+  nodes_.resize(1);
+  buildNode(0, 0, elements_.size());
+}
+
+void AabbTree::clear() {
+  nodes_.clear();
+  boxes_.clear();
+  elements_.clear();
+}
+
+void AabbTree::buildNode(uint32_t index, uint32_t first, uint32_t last) {
+  Ogre::AxisAlignedBox box;
+  Ogre::AxisAlignedBox centers;
+  for (uint32_t it = first; it < last; it++) {
+    box.merge(boxes_[elements_[it]]);
+    centers.merge(boxes_[elements_[it]].getCenter());
+  }
+  nodes_[index] = Node{box, 0, first, last - first};
+  if (last - first <= max_leaf_size)
+    return;
+
+  // split at the median along the longest extent of the centers of the boxes
+  const Ogre::Vector3 extent = centers.getSize();
+  const int           axis   = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+  const uint32_t      middle = first + (last - first) / 2;
+  std::nth_element(elements_.begin() + first, elements_.begin() + middle, elements_.begin() + last,
+                   [this, axis](uint32_t a, uint32_t b) { return boxes_[a].getCenter()[axis] < boxes_[b].getCenter()[axis]; });
+
+  // the children are stored next to each other
+  const uint32_t left = nodes_.size();
+  nodes_.resize(left + 2);
+  nodes_[index].left  = left;
+  nodes_[index].count = 0;
+  buildNode(left, first, middle);
+  buildNode(left + 1, middle, last);
+}
+
+void AabbTree::collectBoxes(size_t max_boxes, std::vector<Ogre::AxisAlignedBox>& boxes) const {
+  if (nodes_.empty() || max_boxes == 0)
+    return;
+
+  // descend level by level while the next level fits
+  std::vector<uint32_t> level = {0};
+  std::vector<uint32_t> next;
+  while (true) {
+    next.clear();
+    for (const uint32_t node : level) {
+      if (nodes_[node].left == 0) {
+        next.push_back(node);
+      } else {
+        next.push_back(nodes_[node].left);
+        next.push_back(nodes_[node].left + 1);
+      }
+    }
+    if (next.size() == level.size() || next.size() > max_boxes)
+      break;
+    level.swap(next);
+  }
+
+  for (const uint32_t node : level)
+    boxes.push_back(nodes_[node].box);
+}
+
+}  // namespace selection
+
+}  // namespace mrs_rviz_plugins
@@ -0,0 +1,56 @@
+#include <selection/paged_properties.h>
+
+#include <rviz/properties/int_property.h>
+
+#include <algorithm>
+
+namespace mrs_rviz_plugins
+{
+
+namespace selection
+{
+
+PagedProperties::PagedProperties() : parent_(nullptr), page_property_(nullptr), n_elements_(0) {
+}
+
+void PagedProperties::create(rviz::Property* parent, size_t n_elements, QObject* receiver, const char* changed_slot, const RowFactory& factory) {
+  parent_     = parent;
+  n_elements_ = n_elements;
+  factory_    = factory;
+  rows_.clear();
+
+  const int n_pages = std::max<int>((n_elements + page_size - 1) / page_size, 1);
+  page_property_    = new rviz::IntProperty("Page", 0, QString("Page of the listed elements, %1 per page, %2 elements in %3 pages").arg(page_size).arg(n_elements).arg(n_pages),
+                                            parent_, changed_slot, receiver);
+  page_property_->setMin(0);
+  page_property_->setMax(n_pages - 1);
+  page_property_->setHidden(n_pages == 1);
+
+  updatePage();
+}
+
+void PagedProperties::updatePage() {
+  if (!page_property_)
+    return;
+
+  // a property removes itself from its parent when deleted
+  for (rviz::Property* row : rows_)
+    delete row;
+  rows_.clear();
+
+  const size_t first = page_property_->getInt() * page_size;
+  const size_t last  = std::min(first + page_size, n_elements_);
+  for (size_t index = first; index < last; index++)
+    rows_.push_back(factory_(index, parent_));
+}
+
+void PagedProperties::reset() {
+  parent_        = nullptr;
+  page_property_ = nullptr;
+  rows_.clear();
+  factory_ = RowFactory();
+}
+
+}  // namespace selection
+
+}  // namespace mrs_rviz_plugins
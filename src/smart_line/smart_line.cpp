@@ -1,6 +1,7 @@
  #include "smart_line/smart_line.h"
  
  #include <sstream>
+#include <unordered_map>
  
  #include <OgreSceneNode.h>
  #include <OgreSceneManager.h>
@@ -10,23 +11,112 @@
  
  namespace rviz
  {
-     void SmartLine::setColorUnshaded(const Ogre::ColourValue& c){
-       /* manual_object_material_->setLightingEnabled(false); */
-       manual_object_material_->setAmbient(c);
-       manual_object_material_->setDiffuse(c);
-       manual_object_material_->setSelfIllumination(c);
-       manual_object_material_->setShadingMode(Ogre::SO_FLAT);
+   namespace
+   {
+     // Unshaded line materials shared by all the lines of the process, keyed by their color quantized to RGBA8
+     struct SharedMaterial
+     {
+       Ogre::MaterialPtr material;
+       size_t references;
+     };
+
+     std::unordered_map<Ogre::RGBA, SharedMaterial>& sharedMaterials()
+     {
+       static std::unordered_map<Ogre::RGBA, SharedMaterial> materials;
+       return materials;
+     }
+
+     Ogre::MaterialPtr acquireMaterial(const Ogre::ColourValue& c, const Ogre::String& group)
+     {
+       const Ogre::RGBA key = c.getAsRGBA();
+       auto found = sharedMaterials().find(key);
+       if (found != sharedMaterials().end())
+       {
+         found->second.references++;
+         return found->second.material;
+       }
+
+       std::stringstream ss;
+       ss << "SmartLineUnshaded" << std::hex << key;
+       Ogre::MaterialPtr material = Ogre::MaterialManager::getSingleton().create(ss.str(), group);
+       material->setReceiveShadows(false);
+       material->setAmbient(c);
+       material->setDiffuse(c);
+       material->setSelfIllumination(c);
+       material->setShadingMode(Ogre::SO_FLAT);
 
        if (c.a < 0.9998)
        {
-         manual_object_material_->getTechnique(0)->setSceneBlending(Ogre::SBT_TRANSPARENT_ALPHA);
-         manual_object_material_->getTechnique(0)->setDepthWriteEnabled(false);
+         material->getTechnique(0)->setSceneBlending(Ogre::SBT_TRANSPARENT_ALPHA);
+         material->getTechnique(0)->setDepthWriteEnabled(false);
        }
        else
        {
-         manual_object_material_->getTechnique(0)->setSceneBlending(Ogre::SBT_REPLACE);
-         manual_object_material_->getTechnique(0)->setDepthWriteEnabled(true);
+         material->getTechnique(0)->setSceneBlending(Ogre::SBT_REPLACE);
+         material->getTechnique(0)->setDepthWriteEnabled(true);
+       }
+
+       sharedMaterials()[key] = SharedMaterial{material, 1};
+       return material;
+     }
+
+     void releaseMaterial(const Ogre::RGBA key)
+     {
+       auto found = sharedMaterials().find(key);
+       if (found != sharedMaterials().end() && --found->second.references == 0)
+       {
+         Ogre::MaterialManager::getSingleton().remove(found->second.material->getName());
+         sharedMaterials().erase(found);
+       }
+     }
+   } // namespace
+
+     SmartLine::~SmartLine()
+     {
+       // Line removes manual_object_material_ from the material manager, it must not be the shared one
+       releaseSharedMaterial();
+     }
+
+     void SmartLine::setColorUnshaded(const Ogre::ColourValue& c){
+       if (own_material_.isNull())
+       {
+         own_material_ = manual_object_material_;
+       }
+
+       // instead of setting up a material of its own, the line takes the one of its color from the cache
+       Ogre::MaterialPtr material = acquireMaterial(c, own_material_->getGroup());
+       releaseSharedMaterial();
+       shared_material_ = material;
+       shared_key_ = c.getAsRGBA();
+       useMaterial(shared_material_);
+     }
+
+     void SmartLine::setColor(float r, float g, float b, float a)
+     {
+       // a shaded color is set on the own material, the shared one is left to the other lines
+       releaseSharedMaterial();
+       Line::setColor(r, g, b, a);
+     }
+
+     void SmartLine::useMaterial(const Ogre::MaterialPtr& material)
+     {
+       manual_object_material_ = material;
+       // the points may already be set, they keep the material they were created with otherwise
+       if (manual_object_->getNumSections() > 0)
+       {
+         manual_object_->setMaterialName(0, material->getName(), material->getGroup());
+       }
+     }
+
+     void SmartLine::releaseSharedMaterial()
+     {
+       if (shared_material_.isNull())
+       {
+         return;
        }
+       useMaterial(own_material_);
+       releaseMaterial(shared_key_);
+       shared_material_.setNull();
      }
  
  } // namespace rviz
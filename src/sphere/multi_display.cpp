@@ -0,0 +1,344 @@
+// clang: MatousFormat
+
+/* includes //{ */
+
+#include <OGRE/OgreSceneNode.h>
+#include <OGRE/OgreSceneManager.h>
+#include <OGRE/OgreManualObject.h>
+#include <OGRE/OgreMaterialManager.h>
+#include <OGRE/OgreTechnique.h>
+
+#include <rviz/display_context.h>
+#include <rviz/frame_manager.h>
+#include <rviz/view_manager.h>
+#include <rviz/view_controller.h>
+#include <rviz/properties/bool_property.h>
+#include <rviz/properties/color_property.h>
+#include <rviz/properties/float_property.h>
+#include <rviz/properties/string_property.h>
+#include <rviz/properties/status_property.h>
+
+#include <sphere/multi_display.h>
+#include <sphere/unit_circle.h>
+
+#include <cmath>
+
+//}
+
+namespace mrs_rviz_plugins
+{
+
+  namespace sphere
+  {
+
+    /* MultiDisplay::MultiDisplay() //{ */
+
+    MultiDisplay::MultiDisplay()
+        : sources_(this, update_nh_, &MultiDisplay::isValid), dirty_(false), manual_object_(nullptr), camera_(nullptr), cam_listener_(this)
+    {
+      topic_pattern_property_ = new rviz::StringProperty("Topic pattern", ".*/sphere",
+                                                         "Regular expression matched against the names of mrs_msgs/Sphere topics to display.", this,
+                                                         SLOT(updateTopicPattern()));
+
+      color_property_ = new rviz::ColorProperty("Color", QColor(255, 0, 255), "Color to draw the shapes.", this, SLOT(updateAppearance()));
+
+      unique_colors_property_ = new rviz::BoolProperty("Unique colors", false, "If true, each topic is drawn in a different color instead of Color.",
+                                                       this, SLOT(updateAppearance()));
+
+      alpha_property_ = new rviz::FloatProperty("Alpha", 1.0, "0 is fully transparent, 1.0 is fully opaque.", this, SLOT(updateAppearance()));
+      alpha_property_->setMin(0.0);
+      alpha_property_->setMax(1.0);
+
+      draw_dynamic_property_ = new rviz::BoolProperty("Draw dynamic circle", true, "Whether the circle always facing the user should be drawn or not.",
+                                                      this, SLOT(updateAppearance()));
+      draw_static_property_ =
+          new rviz::BoolProperty("Draw static circles", true,
+                                 "Whether the circles always oriented with the message's coordinate frame axes should be drawn or not.", this,
+                                 SLOT(updateAppearance()));
+
+      dashed_dynamic_property_ = new rviz::BoolProperty("Dash dynamic circle", true, "Whether the circle always facing the user should be dashed or not.",
+                                                        this, SLOT(updateAppearance()));
+      dashed_static_property_ =
+          new rviz::BoolProperty("Dash static circles", true,
+                                 "Whether the circles always oriented with the message's coordinate frame axes should be dashed or not.", this,
+                                 SLOT(updateAppearance()));
+    }
+
+    //}
+
+    /* MultiDisplay::~MultiDisplay() //{ */
+
+    MultiDisplay::~MultiDisplay()
+    {
+      if (camera_)
+        camera_->removeListener(&cam_listener_);
+      if (manual_object_)
+      {
+        scene_manager_->destroyManualObject(manual_object_);
+        Ogre::MaterialManager::getSingleton().remove(material_->getName());
+      }
+    }
+
+    //}
+
+    /* onInitialize() //{ */
+
+    void MultiDisplay::onInitialize()
+    {
+      static int multi_display_idx = 0;
+      const std::string name = "sphere_multi_display" + std::to_string(multi_display_idx++);
+
+      // all spheres share this material, the colors of the circles are given by their vertices
+      material_ = Ogre::MaterialManager::getSingleton().create(name + "_material", Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+      material_->setReceiveShadows(false);
+      material_->getTechnique(0)->setLightingEnabled(false);
+      material_->getTechnique(0)->setSceneBlending(Ogre::SBT_TRANSPARENT_ALPHA);
+      material_->getTechnique(0)->setDepthWriteEnabled(false);
+
+      manual_object_ = scene_manager_->createManualObject(name);
+      manual_object_->setDynamic(true);
+      scene_node_->attachObject(manual_object_);
+
+      // the cam_listener_ gets callbacks before the camera is rendered, the circles of all spheres are drawn from there
+      rviz::ViewManager::connect(context_->getViewManager(), SIGNAL(currentChanged()), this, SLOT(onViewControllerChanged()));
+      onViewControllerChanged();
+
+      updateTopicPattern();
+    }
+
+    //}
+
+    /* onViewControllerChanged() //{ */
+
+    void MultiDisplay::onViewControllerChanged()
+    {
+      // the previous view controller is deleted together with its camera before this is called, the listener went with it
+      camera_ = nullptr;
+      const rviz::ViewController* view_controller = context_->getViewManager()->getCurrent();
+      if (!view_controller)
+        return;
+      camera_ = view_controller->getCamera();
+      camera_->addListener(&cam_listener_);
+      dirty_ = true;
+    }
+
+    //}
+
+    /* onEnable() and onDisable() //{ */
+
+    void MultiDisplay::onEnable()
+    {
+      sources_.subscribe();
+    }
+
+    void MultiDisplay::onDisable()
+    {
+      sources_.unsubscribe();
+      reset();
+    }
+
+    //}
+
+    /* reset() //{ */
+
+    void MultiDisplay::reset()
+    {
+      rviz::Display::reset();
+      sources_.reset();
+      dirty_ = true;
+    }
+
+    //}
+
+    /* fixedFrameChanged() //{ */
+
+    void MultiDisplay::fixedFrameChanged()
+    {
+      // the stored transforms are relative to the old fixed frame, look them up again
+      sources_.reprocess();
+    }
+
+    //}
+
+    /* updateTopicPattern() //{ */
+
+    void MultiDisplay::updateTopicPattern()
+    {
+      sources_.setPattern(topic_pattern_property_->getStdString());
+      dirty_ = true;
+    }
+
+    //}
+
+    /* updateAppearance() //{ */
+
+    void MultiDisplay::updateAppearance()
+    {
+      dirty_ = true;
+      context_->queueRender();
+    }
+
+    //}
+
+    /* isValid() //{ */
+
+    bool MultiDisplay::isValid(const msg_t& msg, const std::string& topic)
+    {
+      // Sanitize the message to prevent Rviz crashes
+      if (!std::isfinite(msg.radius) || !std::isfinite(msg.position.x) || !std::isfinite(msg.position.y) || !std::isfinite(msg.position.z))
+      {
+        ROS_DEBUG("[MultiDisplay]: Invalid value encountered in mrs_msgs::Sphere message on '%s', skipping message", topic.c_str());
+        return false;
+      }
+      return true;
+    }
+
+    //}
+
+    /* update() //{ */
+
+    void MultiDisplay::update(float wall_dt, [[maybe_unused]] float ros_dt)
+    {
+      // the unique colors are assigned by the order of the topics
+      if (sources_.update(wall_dt))
+        dirty_ = true;
+
+      for (auto& kv : sources_)
+      {
+        auto& source = kv.second;
+        if (!source.new_msg)
+          continue;
+        source.new_msg = false;
+        dirty_ = true;
+
+        // Here we call the rviz::FrameManager to get the transform from the
+        // fixed frame to the frame in the header of this sphere message.
+        Ogre::Vector3 frame_position;
+        source.valid = multi_display::getTransform(context_->getFrameManager(), source.msg->header, frame_position, source.orientation);
+        if (!source.valid)
+        {
+          ROS_DEBUG("[MultiDisplay]: Error transforming from frame '%s' to frame '%s'", source.msg->header.frame_id.c_str(), qPrintable(fixed_frame_));
+          continue;
+        }
+        const Ogre::Vector3 position(source.msg->position.x, source.msg->position.y, source.msg->position.z);
+        source.center = frame_position + source.orientation * position;
+        source.radius = source.msg->radius;
+      }
+
+      if (dirty_)
+        context_->queueRender();
+    }
+
+    //}
+
+    /* sourceColor() //{ */
+
+    Ogre::ColourValue MultiDisplay::sourceColor(const size_t source_idx) const
+    {
+      Ogre::ColourValue color = color_property_->getOgreColor();
+      if (unique_colors_property_->getBool())
+      {
+        // the golden ratio spreads the hues of the consecutive sources evenly
+        const float hue = std::fmod(source_idx * 0.618034f, 1.0f);
+        color.setHSB(hue, 0.8f, 0.9f);
+      }
+      color.a = alpha_property_->getFloat();
+      return color;
+    }
+
+    //}
+
+    /* redraw() //{ */
+
+    void MultiDisplay::redraw(const Ogre::Camera* cam)
+    {
+      // the scene node is hidden while disabled, the line list is rebuilt once enabled again since reset() sets dirty_
+      if (!isEnabled())
+        return;
+
+      const Ogre::Vector3 cam_position = cam->getDerivedPosition();
+      const Ogre::Quaternion cam_orientation = cam->getDerivedOrientation();
+      if (!dirty_ && cam_position == drawn_cam_position_ && cam_orientation == drawn_cam_orientation_)
+        return;
+      dirty_ = false;
+      drawn_cam_position_ = cam_position;
+      drawn_cam_orientation_ = cam_orientation;
+
+      manual_object_->clear();
+
+      const bool draw_dynamic = draw_dynamic_property_->getBool();
+      const bool draw_static = draw_static_property_->getBool();
+      const bool dashed_dynamic = dashed_dynamic_property_->getBool();
+      const bool dashed_static = dashed_static_property_->getBool();
+      const int n_circles = (draw_dynamic ? 1 : 0) + (draw_static ? 3 : 0);
+      if (n_circles == 0)
+        return;
+
+      // every circle is drawn as separate segments, so that the dashed and the solid ones fit into one line list
+      size_t n_vertices = 0;
+      for (auto& kv : sources_)
+      {
+        auto& source = kv.second;
+        if (!source.valid)
+          continue;
+        source.lod = selectLod(lod::screenRadius(cam, source.center, source.radius), source.lod);
+        n_vertices += 2 * lod_segments.at(source.lod) * n_circles;
+      }
+      if (n_vertices == 0)
+        return;
+
+      const auto add_circle = [this](const Ogre::Vector3& center, const Ogre::Vector3& axis_x, const Ogre::Vector3& axis_y,
+                                     const std::vector<Ogre::Vector2>& pts, const bool dashed, const Ogre::ColourValue& color) {
+        // every other segment is left out when dashed, the number of segments is always even
+        for (size_t it = 0; it < pts.size(); it += dashed ? 2 : 1)
+        {
+          const Ogre::Vector2& pt0 = pts[it];
+          const Ogre::Vector2& pt1 = pts[(it + 1) % pts.size()];
+          manual_object_->position(center + axis_x * pt0.x + axis_y * pt0.y);
+          manual_object_->colour(color);
+          manual_object_->position(center + axis_x * pt1.x + axis_y * pt1.y);
+          manual_object_->colour(color);
+        }
+      };
+
+      // the dynamic circles lie in the plane of the screen
+      const Ogre::Vector3 cam_x = cam_orientation * Ogre::Vector3::UNIT_X;
+      const Ogre::Vector3 cam_y = cam_orientation * Ogre::Vector3::UNIT_Y;
+
+      manual_object_->estimateVertexCount(n_vertices);
+      manual_object_->begin(material_->getName(), Ogre::RenderOperation::OT_LINE_LIST);
+      size_t source_idx = 0;
+      for (const auto& kv : sources_)
+      {
+        const auto& source = kv.second;
+        const Ogre::ColourValue color = sourceColor(source_idx);
+        source_idx++;
+        if (!source.valid)
+          continue;
+
+        const std::vector<Ogre::Vector2>& pts = unitCircle(source.lod);
+        if (draw_dynamic)
+          add_circle(source.center, cam_x * source.radius, cam_y * source.radius, pts, dashed_dynamic, color);
+
+        // the static circles lie in the XY, YZ and XZ planes of the message's frame
+        if (draw_static)
+        {
+          const Ogre::Vector3 x = source.orientation * Ogre::Vector3::UNIT_X * source.radius;
+          const Ogre::Vector3 y = source.orientation * Ogre::Vector3::UNIT_Y * source.radius;
+          const Ogre::Vector3 z = source.orientation * Ogre::Vector3::UNIT_Z * source.radius;
+          add_circle(source.center, x, y, pts, dashed_static, color);
+          add_circle(source.center, y, z, pts, dashed_static, color);
+          add_circle(source.center, x, z, pts, dashed_static, color);
+        }
+      }
+      manual_object_->end();
+    }
+
+    //}
+
+  }  // namespace sphere
+
+}  // end namespace mrs_rviz_plugins
+
+#include <pluginlib/class_list_macros.h>
+PLUGINLIB_EXPORT_CLASS(mrs_rviz_plugins::sphere::MultiDisplay, rviz::Display)
@@ -0,0 +1,39 @@
+// clang: MatousFormat
+
+#include <sphere/unit_circle.h>
+
+#include <cmath>
+
+namespace mrs_rviz_plugins
+{
+
+  namespace sphere
+  {
+
+    const std::vector<Ogre::Vector2>& unitCircle(const int lod)
+    {
+      static const std::array<std::vector<Ogre::Vector2>, lod_segments.size()> circles = []() {
+        std::array<std::vector<Ogre::Vector2>, lod_segments.size()> ret;
+        for (size_t lod_it = 0; lod_it < lod_segments.size(); lod_it++)
+        {
+          const int n_segments = lod_segments.at(lod_it);
+          ret.at(lod_it).reserve(n_segments);
+          for (int it = 0; it < n_segments; it++)
+          {
+            const double theta = 2.0 * M_PI * it / n_segments;
+            ret.at(lod_it).emplace_back(std::cos(theta), std::sin(theta));
+          }
+        }
+        return ret;
+      }();
+      return circles.at(lod);
+    }
+
+    int selectLod(const float screen_radius, const int current)
+    {
+      return lod::selectLod(screen_radius, lod_segments, current, lod_hysteresis);
+    }
+
+  }  // namespace sphere
+
+}  // end namespace mrs_rviz_plugins
@@ -52,6 +52,17 @@ namespace mrs_rviz_plugins
       circle_quats_[2] = q;
       q.FromAngleAxis(Ogre::Radian(M_PI_2), Ogre::Vector3(1, 0, 0)); // rotation around x axis by 90 degrees
       circle_quats_[3] = q;
+
+      // the circles are unit circles, their nodes place, orient and scale them
+      for (int it = 0; it < circle_nodes_.size(); it++)
+      {
+        circle_nodes_.at(it) = frame_node_->createChildSceneNode();
+        circle_nodes_.at(it)->setOrientation(circle_quats_.at(it));
+      }
+
+      // the cam_listener_ gets callbacks before the camera is rendered, all the circles are drawn from there
+      camera_ = context_->getViewManager()->getCurrent()->getCamera();
+      camera_->addListener(cam_listener_);
     }
 
     void Visual::freeCircle(Ogre::ManualObject*& circle_ptr)
@@ -64,9 +75,6 @@ namespace mrs_rviz_plugins
 
     Visual::~Visual()
     {
-      // Destroy the frame node since we don't need it anymore.
-      scene_manager_->destroySceneNode(frame_node_);
-
       if (camera_)
       {
         camera_->removeListener(cam_listener_);
@@ -76,91 +84,109 @@ namespace mrs_rviz_plugins
 
       for (auto& circ : circles_)
         freeCircle(circ);
+
+      // Destroy the nodes since we don't need them anymore.
+      for (auto& node : circle_nodes_)
+        scene_manager_->destroySceneNode(node);
+      scene_manager_->destroySceneNode(frame_node_);
+    }
+
+    void Visual::publishParams()
+    {
+      params_buffer_.write(params_);
     }
 
     void Visual::setDrawDynamic(const bool draw)
     {
-      std::lock_guard<std::mutex> lck(circles_quat_mtx_);
-      draw_dynamic_ = draw;
-      // if shouldn't be drawn and is drawn, delete it
-      if (!draw && circle_dyn_)
-      {
-        freeCircle(circle_dyn_);
-        camera_->removeListener(cam_listener_);
-        camera_ = nullptr;
-      }
-      // if should be drawn and isn't drawn, create it
-      else if (draw && !circle_dyn_ && got_msg_)
-      {
-        circle_dyn_ = initCircle(circle_names_.at(0), position_.x, position_.y, position_.z, radius_, circle_quats_.at(0), dashed_dynamic_);
-        // the cam_listener_ gets callbacks before the camera is rendered to redraw the dynamic circle
-        if (!camera_)
-        {
-          camera_ = context_->getViewManager()->getCurrent()->getCamera();
-          camera_->addListener(cam_listener_);
-        }
-      }
+      params_.draw_dynamic = draw;
+      publishParams();
     }
 
     void Visual::setDrawStatic(const bool draw)
     {
-      std::lock_guard<std::mutex> lck(circles_quat_mtx_);
-      draw_static_ = draw;
-      for (int it = 1; it < circles_.size(); it++)
-      {
-        auto& circ = circles_.at(it);
-        // if shouldn't be drawn and is drawn, delete it
-        if (!draw && circ)
-          freeCircle(circ);
-        // if should be drawn and isn't drawn, create it
-        else if (draw && !circ && got_msg_)
-          circ = initCircle(circle_names_.at(it), position_.x, position_.y, position_.z, radius_, circle_quats_.at(it), dashed_static_);
-      }
+      params_.draw_static = draw;
+      publishParams();
     }
 
     void Visual::setDashedDynamic(const bool dashed)
     {
-      std::lock_guard<std::mutex> lck(circles_quat_mtx_);
-      dashed_dynamic_ = dashed;
-      // if shouldn't be drawn and is drawn, delete it
-      if (circle_dyn_)
-      {
-        freeCircle(circle_dyn_);
-        circle_dyn_ = initCircle(circle_names_.at(0), position_.x, position_.y, position_.z, radius_, circle_quats_.at(0), dashed_dynamic_);
-      }
+      params_.dashed_dynamic = dashed;
+      publishParams();
     }
 
     void Visual::setDashedStatic(const bool dashed)
     {
-      std::lock_guard<std::mutex> lck(circles_quat_mtx_);
-      dashed_static_ = dashed;
-      // if shouldn't be drawn and is drawn, delete it
-      for (int it = 1; it < circles_.size(); it++)
+      params_.dashed_static = dashed;
+      publishParams();
+    }
+
+    void Visual::setColor(const float red, const float green, const float blue, const float alpha)
+    {
+      params_.red = red;
+      params_.green = green;
+      params_.blue = blue;
+      params_.alpha = alpha;
+      publishParams();
+    }
+
+    void Visual::setMessage(const mrs_msgs::Sphere::ConstPtr& msg)
+    {
+      params_.radius = msg->radius;
+      params_.position.x = msg->position.x;
+      params_.position.y = msg->position.y;
+      params_.position.z = msg->position.z;
+      params_.got_msg = true;
+      publishParams();
+    }
+
+    void Visual::applyParams(const Ogre::Camera* cam)
+    {
+      const params_t prev = drawn_params_;
+      if (params_buffer_.update())
+        drawn_params_ = params_buffer_.front();
+      const params_t& cur = drawn_params_;
+
+      // the message only moves and scales the circles
+      if (cur.got_msg != prev.got_msg || cur.position != prev.position || cur.radius != prev.radius)
       {
-        auto& circ = circles_.at(it);
-        if (circ)
+        for (auto& node : circle_nodes_)
         {
-          freeCircle(circ);
-          circ = initCircle(circle_names_.at(it), position_.x, position_.y, position_.z, radius_, circle_quats_.at(it), dashed_static_);
+          node->setPosition(cur.position);
+          node->setScale(cur.radius, cur.radius, cur.radius);
         }
       }
-    }
 
-    void Visual::setColor(const float red, const float green, const float blue, const float alpha)
-    {
-      red_ = red;
-      green_ = green;
-      blue_ = blue;
-      alpha_ = alpha;
-      std::lock_guard<std::mutex> lck(circles_quat_mtx_);
+      int lod = lod_;
+      if (cur.got_msg)
+      {
+        const Ogre::Vector3 center = frame_node_->convertLocalToWorldPosition(cur.position);
+        lod = selectLod(lod::screenRadius(cam, center, cur.radius), lod_);
+      }
+      const bool color_changed = cur.red != prev.red || cur.green != prev.green || cur.blue != prev.blue || cur.alpha != prev.alpha;
+      const bool refill = lod != lod_ || color_changed;
+      lod_ = lod;
+
+      // dynamic circle is the one which is always oriented towards the viewer in Rviz,
+      // static circles are the ones which are always oriented according to the message's coordinate frame axes
       for (int it = 0; it < circles_.size(); it++)
       {
         auto& circ = circles_.at(it);
-        if (!circ)
-          continue;
-        circ->beginUpdate(0);
-        fillCircle(circ, position_.x, position_.y, position_.z, radius_, circle_quats_.at(it));
-        circ->end();
+        const bool draw = cur.got_msg && (it == 0 ? cur.draw_dynamic : cur.draw_static);
+        const bool dashed = it == 0 ? cur.dashed_dynamic : cur.dashed_static;
+        const bool dashed_changed = dashed != (it == 0 ? prev.dashed_dynamic : prev.dashed_static);
+
+        // the type of the line cannot be changed, so the circle has to be recreated
+        if (circ && (!draw || dashed_changed))
+          freeCircle(circ);
+
+        if (draw && !circ)
+          circ = initCircle(circle_names_.at(it), circle_nodes_.at(it), dashed);
+        else if (circ && refill)
+        {
+          circ->beginUpdate(0);
+          fillCircle(circ, dashed);
+          circ->end();
+        }
       }
     }
 
@@ -172,74 +198,34 @@ namespace mrs_rviz_plugins
       camera_->addListener(cam_listener_);
     }
 
-    void Visual::fillCircle(Ogre::ManualObject* circle, float x, float y, float z, float r, const Ogre::Quaternion& q, int n_pts)
+    void Visual::fillCircle(Ogre::ManualObject* circle, bool dashed)
     {
-      circle->colour(Ogre::ColourValue(red_, green_, blue_, alpha_));
-      unsigned point_index = 0;
-      for (float theta = 0; theta <= 2 * Ogre::Math::PI; theta += Ogre::Math::PI / n_pts)
+      // the number of segments is always even, every other one is left out when dashed
+      const std::vector<Ogre::Vector2>& pts = unitCircle(lod_);
+      circle->estimateVertexCount(pts.size());
+      circle->colour(Ogre::ColourValue(drawn_params_.red, drawn_params_.green, drawn_params_.blue, drawn_params_.alpha));
+      for (size_t it = 0; it < pts.size(); it++)
       {
-        const Ogre::Vector3 pos = q*Ogre::Vector3(r * cos(theta), r * sin(theta), 0) + Ogre::Vector3(x, y, z);
-        circle->position(pos);
-        circle->index(point_index++);
+        circle->position(pts[it].x, pts[it].y, 0.0f);
+        circle->index(it);
       }
-      circle->index(0); // Rejoins the last point to the first.
+      if (!dashed)
+        circle->index(0); // Rejoins the last point to the first.
     }
 
-    Ogre::ManualObject* Visual::initCircle(const std::string& name, float x, float y, float z, float r, const Ogre::Quaternion& q, bool dashed, int n_pts)
+    Ogre::ManualObject* Visual::initCircle(const std::string& name, Ogre::SceneNode* node, bool dashed)
     {
       Ogre::ManualObject* circle = scene_manager_->createManualObject(name);
+      // the geometry only changes with the color, dashing or level of detail, so keep it in a static buffer
+      circle->setDynamic(false);
       const Ogre::RenderOperation::OperationType op = dashed ? Ogre::RenderOperation::OT_LINE_LIST : Ogre::RenderOperation::OT_LINE_STRIP;
       circle->begin("BaseWhiteNoLighting", op);
-      fillCircle(circle, x, y, z, r, q, n_pts);
+      fillCircle(circle, dashed);
       circle->end();
-      frame_node_->attachObject(circle);
+      node->attachObject(circle);
       return circle;
     }
 
-    void Visual::setMessage(const mrs_msgs::Sphere::ConstPtr& msg)
-    {
-      std::lock_guard<std::mutex> lck(circles_quat_mtx_);
-      radius_ = msg->radius;
-      position_.x = msg->position.x;
-      position_.y = msg->position.y;
-      position_.z = msg->position.z;
-
-      // dynamic circle is the one which is always oriented towards the viewer in Rviz
-      if (draw_dynamic_ && !circle_dyn_)
-      {
-        circle_dyn_ = initCircle(circle_names_.at(0), position_.x, position_.y, position_.z, radius_, circle_quats_.at(0), dashed_dynamic_);
-        // the cam_listener_ gets callbacks before the camera is rendered to redraw the dynamic circle
-        if (!camera_)
-        {
-          camera_ = context_->getViewManager()->getCurrent()->getCamera();
-          camera_->addListener(cam_listener_);
-        }
-      }
-
-      // static circles are the ones which are always oriented according to the message's coordinate frame axes
-      if (draw_static_)
-      {
-        for (int it = 1; it < circles_.size(); it++)
-        {
-          auto& circ = circles_.at(it);
-          if (!circ)
-          {
-            // if the circle is not initialized yet, do it
-            circ = initCircle(circle_names_.at(it), position_.x, position_.y, position_.z, radius_, circle_quats_.at(it), dashed_static_);
-          }
-          else
-          {
-            // otherwise just update it
-            circ->beginUpdate(0);
-            fillCircle(circ, position_.x, position_.y, position_.z, radius_, circle_quats_.at(it));
-            circ->end();
-          }
-        }
-      }
-
-      got_msg_ = true;
-    }
-
     // Position and orientation are passed through to the SceneNode.
     void Visual::setFramePosition(const Ogre::Vector3& position)
     {
@@ -7,6 +7,21 @@ namespace mrs_rviz_plugins
 namespace track_array 
 {
 
+namespace
+{
+
+// Copies a row-major 3x3 covariance into the diagonal block of a row-major 6x6 one starting at the given row and column
+template <typename Block>
+void copyCovarianceBlock(const Block& block, size_t first, boost::array<double, 36>& covariance) {
+  for (size_t row = 0; row < 3; row++) {
+    for (size_t col = 0; col < 3; col++) {
+      covariance[6 * (first + row) + first + col] = block[3 * row + col];
+    }
+  }
+}
+
+}  // namespace
+
 /* DisplaySelectionHandler and some functions from 
         https://github.com/ctu-mrs/mrs_rviz_plugins/blob/master/src/pose_with_covariance_array/display.cpp/ */
 
@@ -21,11 +36,13 @@ public:
     rviz::Property* tmp = new rviz::StringProperty("frame ID", (message_->header.frame_id).c_str(), "name of the frame", root);
     tmp->setReadOnly(true);
 
-    for (const auto& cur_track : message_->tracks)
-    {
-      rviz::Property* sub_root = new rviz::Property(("TrackWithCovariance " + std::to_string(cur_track.id)).c_str(), QVariant(), "position, orientation and velocity with covariance", root);
-      
-      tmp = new rviz::IntProperty("ID", cur_track.id, "ID", sub_root);
+    // only the tracks of the current page get their properties
+    const auto message = message_;
+    pages_.create(root, message->tracks.size(), display_, SLOT(updateSelectionPage()), [message](size_t index, rviz::Property* parent) {
+      const auto& cur_track = message->tracks[index];
+      rviz::Property* sub_root = new rviz::Property(("TrackWithCovariance " + std::to_string(cur_track.id)).c_str(), QVariant(), "position, orientation and velocity with covariance", parent);
+
+      rviz::Property* tmp = new rviz::IntProperty("ID", cur_track.id, "ID", sub_root);
       tmp->setReadOnly(true);
       tmp = new rviz::VectorProperty("position", Ogre::Vector3(cur_track.position.x, cur_track.position.y, 
               cur_track.position.z), "position", sub_root);
@@ -33,62 +50,89 @@ public:
       tmp = new rviz::QuaternionProperty("orientation", Ogre::Quaternion(cur_track.orientation.w, 
               cur_track.orientation.x, cur_track.orientation.y, cur_track.orientation.z), "orientation", sub_root);
       tmp->setReadOnly(true);
-    }
+      return sub_root;
+    });
     root_->setParent(parent_property);
   }
 
+  void destroyProperties(const rviz::Picked& obj, rviz::Property* parent_property) {
+    pages_.reset();
+    SelectionHandler::destroyProperties(obj, parent_property);
+  }
+
+  void updatePage() {
+    pages_.updatePage();
+  }
+
   void getAABBs([[maybe_unused]] const rviz::Picked& obj, rviz::V_AABB& aabbs) {
+    if (!display_->pose_valid_) {
+      return;
+    }
 
-    for (const auto& cur_track : display_->disp_data_) {
-      if (display_->pose_valid_) {
-        aabbs.push_back(cur_track.arrow_vel_->getHead()->getEntity()->getWorldBoundingBox());
-        aabbs.push_back(cur_track.arrow_vel_->getShaft()->getEntity()->getWorldBoundingBox());
-
-        aabbs.push_back(cur_track.axes_pose_->getXShape()->getEntity()->getWorldBoundingBox());
-        aabbs.push_back(cur_track.axes_pose_->getYShape()->getEntity()->getWorldBoundingBox());
-        aabbs.push_back(cur_track.axes_pose_->getZShape()->getEntity()->getWorldBoundingBox());
-
-        if (display_->pose_covariance_property_->getBool()) {
-          if (display_->pose_covariance_property_->getPositionBool()) {
-            aabbs.push_back(cur_track.covariance_pose_->getPositionShape()->getEntity()->getWorldBoundingBox());
-          }
-          if (display_->pose_covariance_property_->getOrientationBool()) {
-            aabbs.push_back(
-                cur_track.covariance_pose_->getOrientationShape(rviz::CovarianceVisual::kRoll)->getEntity()->getWorldBoundingBox());
-            aabbs.push_back(
-                cur_track.covariance_pose_->getOrientationShape(rviz::CovarianceVisual::kPitch)->getEntity()->getWorldBoundingBox());
-            aabbs.push_back(
-                cur_track.covariance_pose_->getOrientationShape(rviz::CovarianceVisual::kYaw)->getEntity()->getWorldBoundingBox());
-          }
-        }
-
-        if (display_->velocity_covariance_property_->getBool()) {
-          if (display_->velocity_covariance_property_->getPositionBool()) {
-            aabbs.push_back(cur_track.covariance_vel_->getPositionShape()->getEntity()->getWorldBoundingBox());
-          }
-          if (display_->velocity_covariance_property_->getOrientationBool()) {
-            aabbs.push_back(
-                cur_track.covariance_vel_->getOrientationShape(rviz::CovarianceVisual::kRoll)->getEntity()->getWorldBoundingBox());
-            aabbs.push_back(
-                cur_track.covariance_vel_->getOrientationShape(rviz::CovarianceVisual::kPitch)->getEntity()->getWorldBoundingBox());
-            aabbs.push_back(
-                cur_track.covariance_vel_->getOrientationShape(rviz::CovarianceVisual::kYaw)->getEntity()->getWorldBoundingBox());
-          }
-        }
-      }
+    // the covariances of all the tracks are in the same two meshes per property
+    collectCovariance(*display_->pose_covariance_property_, *display_->covariance_pose_batch_, aabbs);
+    if (display_->velocity_valid_) {
+      collectCovariance(*display_->velocity_covariance_property_, *display_->covariance_vel_batch_, aabbs);
     }
+
+    // the boxes of the tracks are only collected once per message,
+    // the highlight then consists of a bounded number of boxes each enclosing a group of tracks
+    if (boxes_dirty_) {
+      buildBoxes();
+    }
+    boxes_.collectBoxes(max_highlight_boxes, aabbs);
   }
 
   void setMessage(const mrs_msgs::TrackArrayStampedConstPtr& message) {
     message_ = message;
     tracked_objects_.clear();
+    invalidateBoxes();
     /* updateProperties(); */
   }
 
+  void invalidateBoxes() {
+    boxes_dirty_ = true;
+  }
+
 private:
   std::unique_ptr<rviz::Property> root_;
   mrs_msgs::TrackArrayStampedConstPtr message_;
+
+  static void collectCovariance(covariance::Property& property, covariance::BatchVisual& batch, rviz::V_AABB& aabbs) {
+    if (!property.getBool()) {
+      return;
+    }
+    if (property.getPositionBool()) {
+      aabbs.push_back(batch.getPositionObject()->getWorldBoundingBox());
+    }
+    if (property.getOrientationBool()) {
+      aabbs.push_back(batch.getOrientationObject()->getWorldBoundingBox());
+    }
+  }
+
+  // the boxes are derived from the nodes here, the cached world boxes still hold the poses of the last frame
+  void buildBoxes() {
+    std::vector<Ogre::AxisAlignedBox> track_boxes;
+    track_boxes.reserve(display_->disp_data_.size());
+    for (const auto& cur_track : display_->disp_data_) {
+      Ogre::AxisAlignedBox box;
+      box.merge(cur_track.arrow_vel_->getHead()->getEntity()->getWorldBoundingBox(true));
+      box.merge(cur_track.arrow_vel_->getShaft()->getEntity()->getWorldBoundingBox(true));
+      box.merge(cur_track.axes_pose_->getXShape()->getEntity()->getWorldBoundingBox(true));
+      box.merge(cur_track.axes_pose_->getYShape()->getEntity()->getWorldBoundingBox(true));
+      box.merge(cur_track.axes_pose_->getZShape()->getEntity()->getWorldBoundingBox(true));
+      track_boxes.push_back(box);
+    }
+    boxes_.build(track_boxes);
+    boxes_dirty_ = false;
+  }
+
+  static constexpr size_t max_highlight_boxes = 64;
+
   Display* display_;
+  selection::PagedProperties pages_;
+  selection::AabbTree boxes_;
+  bool boxes_dirty_ = true;
 };
 
 
@@ -133,12 +177,12 @@ Display::Display() : pose_valid_(false) {
 
 
   /* Pose Covariance */
-  pose_covariance_property_ = std::make_unique<rviz::CovarianceProperty>("Covariance Pose", true, 
+  pose_covariance_property_ = std::make_unique<covariance::Property>("Covariance Pose", true, 
         "Whether or not the covariances of the pose should be shown.", this, SLOT(queueRender()));
 
 
   /* Velocity Covariance */
-  velocity_covariance_property_ = std::make_unique<rviz::CovarianceProperty>("Covariance Velocity", true, 
+  velocity_covariance_property_ = std::make_unique<covariance::Property>("Covariance Velocity", true, 
         "Whether or not the covariances of velocity should be shown.", this, SLOT(queueRender()));
   if (velocity_covariance_property_->childAt(0)) velocity_covariance_property_->childAt(0)->hide(); //Hide Position
   if (velocity_covariance_property_->childAt(1)) velocity_covariance_property_->childAt(1)->hide(); //Hide Orientation
@@ -179,6 +223,8 @@ void Display::onInitialize() {
   MFDClass::onInitialize();
 
   coll_handler_ = std::make_unique<DisplaySelectionHandler>(this, context_);
+  covariance_pose_batch_ = pose_covariance_property_->createBatchVisual(scene_manager_, scene_node_);
+  covariance_vel_batch_  = velocity_covariance_property_->createBatchVisual(scene_manager_, scene_node_);
   for (auto& d : disp_data_) {
     d.arrow_vel_ = boost::make_shared<rviz::Arrow>(scene_manager_, scene_node_, velocity_arrow_length_scale_property_->getFloat(), 
             velocity_arrow_radius_property_->getFloat(), velocity_arrow_head_length_property_->getFloat(), 
@@ -192,10 +238,6 @@ void Display::onInitialize() {
     d.axes_pose_ = boost::make_shared<rviz::Axes>(scene_manager_, scene_node_, axes_length_property_->getFloat(), 
             axes_radius_property_->getFloat());
 
-    d.covariance_pose_ = pose_covariance_property_->createAndPushBackVisual(scene_manager_, scene_node_);
-
-    d.covariance_vel_ = velocity_covariance_property_->createAndPushBackVisual(scene_manager_, scene_node_);
-
     d.text_id_ = boost::make_shared<TextID>(scene_manager_, scene_node_);
   }
 
@@ -210,8 +252,6 @@ void Display::onInitialize() {
 
 
 Display::~Display() {
-    pose_covariance_property_->clearVisual();
-    velocity_covariance_property_->clearVisual();
 }
 
 
@@ -242,9 +282,9 @@ void Display::updateVelocityColorAndAlpha() {
 
   for (auto& d : disp_data_) {
     d.arrow_vel_->setColor(color); 
-    d.covariance_vel_->setPositionColor(color_cov);
-    d.covariance_vel_->setOrientationColor(color_cov);
   }
+  covariance_vel_batch_->setPositionColor(color_cov.r, color_cov.g, color_cov.b, color_cov.a);
+  covariance_vel_batch_->setOrientationColor(color_cov.r, color_cov.g, color_cov.b, color_cov.a);
 
   context_->queueRender();
 }
@@ -255,6 +295,7 @@ void Display::updateVelocityArrowGeometry() {
     d.arrow_vel_->set(velocity_arrow_length_scale_property_->getFloat()*d.arrow_vel_len_, velocity_arrow_radius_property_->getFloat(), 
             velocity_arrow_head_length_property_->getFloat(), velocity_arrow_head_radius_property_->getFloat());
   }
+  coll_handler_->invalidateBoxes();
   context_->queueRender();
 }
 
@@ -263,6 +304,7 @@ void Display::updateAxesGeometry() {
   for (auto& d : disp_data_) {
     d.axes_pose_->set(axes_length_property_->getFloat(), axes_radius_property_->getFloat());
   }
+  coll_handler_->invalidateBoxes();
   context_->queueRender();
 }
 
@@ -314,9 +356,7 @@ void Display::updateTextIDVisibility() {
 
 void Display::updateCovariancePoseVisibility() {
   if (!pose_valid_) {
-    for (auto& d : disp_data_) {
-      d.covariance_pose_->setVisible(false);
-    }
+    covariance_pose_batch_->setVisible(false);
   } else {
     pose_covariance_property_->updateVisibility();
   }
@@ -325,15 +365,26 @@ void Display::updateCovariancePoseVisibility() {
 
 void Display::updateCovarianceVelocityVisibility() {
   if (!(velocity_valid_ && pose_valid_)) {
-    for (auto& d : disp_data_) {
-      d.covariance_vel_->setVisible(false);
-    }
+    covariance_vel_batch_->setVisible(false);
   } else {
     velocity_covariance_property_->updateVisibility();
   }
 }
 
 
+void Display::updateSelectionPage() {
+  coll_handler_->updatePage();
+}
+
+
+void Display::update(float wall_dt, float ros_dt) {
+  MFDClass::update(wall_dt, ros_dt);
+
+  rviz::ViewController* view = context_->getViewManager()->getCurrent();
+  covariance_pose_batch_->update(view ? view->getCamera() : nullptr);
+  covariance_vel_batch_->update(view ? view->getCamera() : nullptr);
+}
+
 void Display::reset() {
   MFDClass::reset();
   pose_valid_ = false;
@@ -344,31 +395,71 @@ void Display::reset() {
 
 
 void Display::processMessage(const mrs_msgs::TrackArrayStamped::ConstPtr& message) {
-  disp_data_.clear();
+  coll_handler_->setMessage(message);
 
-  while (pose_covariance_property_->sizeVisual() > 0) {
-    pose_covariance_property_->popFrontVisual();
+  // All the tracks share the header, so the transform to the fixed frame is looked up only once and applied to all of them
+  Ogre::Vector3    frame_position;
+  Ogre::Quaternion frame_orientation;
+  if (!context_->getFrameManager()->getTransform(message->header, frame_position, frame_orientation)) {
+    ROS_ERROR("Error transforming tracks '%s' from frame '%s' to frame '%s'", qPrintable(getName()), message->header.frame_id.c_str(),
+              qPrintable(fixed_frame_));
+    for (auto& d : disp_data_) {
+      releaseTrack(d);
+    }
+    disp_data_.clear();
+    track_index_.clear();
+    covariance_pose_batch_->clear();
+    covariance_vel_batch_->clear();
+    return;
   }
 
-  while (velocity_covariance_property_->sizeVisual() > 0) {
-    velocity_covariance_property_->popFrontVisual();
+  std::vector<Ogre::Vector3>    positions(message->tracks.size());
+  std::vector<Ogre::Quaternion> orientations(message->tracks.size());
+  for (size_t it = 0; it < message->tracks.size(); it++) {
+    const mrs_msgs::Track& track = message->tracks[it];
+    frame_transform::applyFrameTransform(frame_position, frame_orientation, Ogre::Vector3(track.position.x, track.position.y, track.position.z),
+                                         Ogre::Quaternion(track.orientation.w, track.orientation.x, track.orientation.y, track.orientation.z),
+                                         positions[it], orientations[it]);
   }
 
-  coll_handler_->setMessage(message);
+  // The objects of the tracks of the previous message are updated in place when their id persists,
+  // the tracks with new ids take the objects of the disappeared ones from the pool.
+  std::vector<display_object> previous_data;
+  previous_data.swap(disp_data_);
+  std::unordered_map<mrs_msgs::Track::_id_type, size_t> previous_index;
+  previous_index.swap(track_index_);
+  std::vector<bool> reused(previous_data.size(), false);
+
+  // The covariances of all the tracks are decoded into these two, the blocks between position and orientation stay zero
+  boost::array<double, 36> pose_covariance;
+  boost::array<double, 36> velocity_covariance;
+  pose_covariance.fill(0.0);
+  velocity_covariance.fill(0.0);
+
+  covariance_pose_batch_->clear();
+  covariance_vel_batch_->clear();
+  coll_handler_->addTrackedObjects(covariance_pose_batch_->getSceneNode());
+  coll_handler_->addTrackedObjects(covariance_vel_batch_->getSceneNode());
 
   for (int i = 0; i < (int)(message->tracks.size()); i++) {
 
-    /* Set pose */
+    /* Validate the track */
     if (!rviz::validateFloats(message->tracks[i].position) || !rviz::validateFloats(message->tracks[i].position_covariance)) {
       setStatus(rviz::StatusProperty::Error, "Topic", "Message contained invalid floating point position values (nans or infs)");
-      return;
+      break;
     }
 
-    geometry_msgs::Pose pose_msg;
-    pose_msg.position = message->tracks[i].position;
-    pose_msg.orientation = message->tracks[i].orientation;
+    if (!rviz::validateFloats(message->tracks[i].velocity) || !rviz::validateFloats(message->tracks[i].velocity_covariance)) {
+      setStatus(rviz::StatusProperty::Error, "Topic", "Message contained invalid floating point velocity values (nans or infs)");
+      break;
+    }
+
+    const geometry_msgs::Point&      position    = message->tracks[i].position;
+    const geometry_msgs::Quaternion& orientation = message->tracks[i].orientation;
+    const double source_position[3]    = {position.x, position.y, position.z};
+    const double source_orientation[4] = {orientation.x, orientation.y, orientation.z, orientation.w};
 
-    if (!rviz::validateQuaternions(pose_msg)) {
+    if (!rviz::validateQuaternions(orientation)) {
       ROS_WARN_ONCE_NAMED("quaternions",
                           "Track '%s' contains unnormalized quaternions. "
                           "This warning will only be output once but may be true for others; "
@@ -377,95 +468,55 @@ void Display::processMessage(const mrs_msgs::TrackArrayStamped::ConstPtr& messag
       ROS_DEBUG_NAMED("quaternions", "Track '%s' contains unnormalized quaternions.", qPrintable(getName()));
     }
 
-    Ogre::Vector3    position_pose;
-    Ogre::Quaternion orientation_pose;
-    if (!context_->getFrameManager()->transform(message->header, pose_msg, position_pose, orientation_pose)) {
-      ROS_ERROR("Error transforming track '%s' from frame '%s' to frame '%s'", qPrintable(getName()), message->header.frame_id.c_str(),
-                qPrintable(fixed_frame_));
-      return;
-    }
+    const Ogre::Vector3&    position_pose    = positions[i];
+    const Ogre::Quaternion& orientation_pose = orientations[i];
 
     pose_valid_ = true;
+    velocity_valid_ = true;
 
-    disp_data_.push_back(display_object());
-    auto& d = disp_data_.back();
-
-    d.axes_pose_ = boost::make_shared<rviz::Axes>(scene_manager_, scene_node_, axes_length_property_->getFloat(), 
-            axes_radius_property_->getFloat());
+    /* Find the objects of the track */
+    display_object d;
+    const auto previous = previous_index.find(message->tracks[i].id);
+    if (previous != previous_index.end() && !reused[previous->second]) {
+      d = previous_data[previous->second];
+      reused[previous->second] = true;
+    } else {
+      d = acquireTrack();
+    }
 
+    /* Set pose */
     d.axes_pose_->setPosition(position_pose);
     d.axes_pose_->setOrientation(orientation_pose);
 
 
     /* Set pose covariance */
-    d.covariance_pose_ = pose_covariance_property_->createAndPushBackVisual(scene_manager_, scene_node_);
-
-    d.covariance_pose_->setPosition(position_pose);
-    d.covariance_pose_->setOrientation(orientation_pose);
-
-    geometry_msgs::PoseWithCovariance pwc_msg;
-    boost::array<double, 36> tmp_cov_pose{0}; //36 is size of covariance array from geometry_msgs/PoseWithCovariance
-
-    int c = 0;
-    for (int j = 0; j < 9; ++j) { //9 is position_covariance size
-      if (j > 0 && j%3 == 0) c += 3;
-      tmp_cov_pose[j+c] = message->tracks[i].position_covariance[j];
-    }
-
-    c = 21;
-    for (int j = 0; j < 9; ++j) { //9 is orientation_covariance size
-      if (j > 0 && j%3 == 0) c += 3;
-      tmp_cov_pose[j+c] = message->tracks[i].orientation_covariance[j];
-    }
-
-    pwc_msg.covariance = tmp_cov_pose;
-    pwc_msg.pose       = pose_msg;
-    d.covariance_pose_->setCovariance(pwc_msg);
+    copyCovarianceBlock(message->tracks[i].position_covariance, 0, pose_covariance);
+    copyCovarianceBlock(message->tracks[i].orientation_covariance, 3, pose_covariance);
+    covariance_pose_batch_->add(position_pose, orientation_pose, source_position, source_orientation, pose_covariance.data());
 
 
     /* Set velocity */
-    if (!rviz::validateFloats(message->tracks[i].velocity) || !rviz::validateFloats(message->tracks[i].velocity_covariance)) {
-      setStatus(rviz::StatusProperty::Error, "Topic", "Message contained invalid floating point velocity values (nans or infs)");
-      return;
-    }
-
-    velocity_valid_ = true;
-
     const geometry_msgs::Vector3 tmp = message->tracks[i].velocity;
     Ogre::Vector3 direction = Ogre::Vector3(tmp.x, tmp.y, tmp.z);
     
     d.arrow_vel_len_ = direction.length();
     float shaft_length = velocity_arrow_length_scale_property_->getFloat() * d.arrow_vel_len_;
-    d.arrow_vel_ = boost::make_shared<rviz::Arrow>(scene_manager_, scene_node_, shaft_length, velocity_arrow_radius_property_->getFloat(), 
-            velocity_arrow_head_length_property_->getFloat(), velocity_arrow_head_radius_property_->getFloat());
+    d.arrow_vel_->set(shaft_length, velocity_arrow_radius_property_->getFloat(), velocity_arrow_head_length_property_->getFloat(),
+            velocity_arrow_head_radius_property_->getFloat());
 
     d.arrow_vel_->setPosition(position_pose);
     d.arrow_vel_->setDirection(direction);
 
 
     /* Set velocity covariance */
-    d.covariance_vel_ = velocity_covariance_property_->createAndPushBackVisual(scene_manager_, scene_node_);
+    // the velocity has no orientation part, that block stays zero
+    copyCovarianceBlock(message->tracks[i].velocity_covariance, 0, velocity_covariance);
+    covariance_vel_batch_->add(position_pose, orientation_pose, source_position, source_orientation, velocity_covariance.data());
 
-    d.covariance_vel_->setPosition(position_pose);
-    d.covariance_vel_->setOrientation(orientation_pose);
 
-    geometry_msgs::PoseWithCovariance vel_msg;
-    boost::array<double, 36> tmp_cov_vel{0}; //36 is size of covariance array from geometry_msgs/PoseWithCovariance
-
-    c = 0;
-    for (int j = 0; j < 9; ++j) { //9 is velocity_covariance size
-      if (j > 0 && j%3 == 0) c += 3;
-      tmp_cov_vel[j+c] = message->tracks[i].velocity_covariance[j];
-    }
-
-    vel_msg.covariance = tmp_cov_vel;
-    vel_msg.pose       = pose_msg;
-    d.covariance_vel_->setCovariance(vel_msg);
-
-
-    /* Create text marker with id */
-    d.text_id_ = boost::make_shared<TextID>(scene_manager_, scene_node_);
-    d.text_id_->setPosition(position_pose, id_text_shift_x_property_->getFloat(), id_text_shift_y_property_->getFloat(),
+    /* Set text marker with id */
+    Ogre::Vector3 text_position = position_pose;
+    d.text_id_->setPosition(text_position, id_text_shift_x_property_->getFloat(), id_text_shift_y_property_->getFloat(),
             id_text_shift_z_property_->getFloat());
 
     Ogre::ColourValue color = id_text_color_property_->getOgreColor();
@@ -475,15 +526,22 @@ void Display::processMessage(const mrs_msgs::TrackArrayStamped::ConstPtr& messag
 
     coll_handler_->addTrackedObjects(d.arrow_vel_->getSceneNode());
     coll_handler_->addTrackedObjects(d.axes_pose_->getSceneNode());
-    coll_handler_->addTrackedObjects(d.covariance_pose_->getPositionSceneNode());
-    coll_handler_->addTrackedObjects(d.covariance_pose_->getOrientationSceneNode());
-    coll_handler_->addTrackedObjects(d.covariance_vel_->getPositionSceneNode());
-    coll_handler_->addTrackedObjects(d.covariance_vel_->getOrientationSceneNode());
     coll_handler_->addTrackedObjects(d.text_id_->getSceneNode());
-    
+
+    // with duplicate ids, only the first track keeps its objects for the next message
+    track_index_.emplace(message->tracks[i].id, disp_data_.size());
+    disp_data_.push_back(d);
+
     context_->queueRender();
   }
 
+  // the tracks which disappeared return their objects to the pool
+  for (size_t it = 0; it < previous_data.size(); it++) {
+    if (!reused[it]) {
+      releaseTrack(previous_data[it]);
+    }
+  }
+
   updateCovariancePoseVisibility();
   updateCovarianceVelocityVisibility();
   updateVelocityArrowVisibility();
@@ -493,6 +551,44 @@ void Display::processMessage(const mrs_msgs::TrackArrayStamped::ConstPtr& messag
 }
 
 
+display_object Display::acquireTrack() {
+  if (!track_pool_.empty()) {
+    display_object d = track_pool_.back();
+    track_pool_.pop_back();
+    scene_node_->addChild(d.node_.get());
+
+    // the slots only update the shown tracks, the rest of the appearance is set with each message
+    d.axes_pose_->set(axes_length_property_->getFloat(), axes_radius_property_->getFloat());
+    return d;
+  }
+
+  // all the objects of a track are under its own scene node, so the whole track is hidden by detaching it
+  display_object d;
+  Ogre::SceneManager* scene_manager = scene_manager_;
+  d.node_ = boost::shared_ptr<Ogre::SceneNode>(scene_node_->createChildSceneNode(), [scene_manager](Ogre::SceneNode* node) {
+    scene_manager->destroySceneNode(node);
+  });
+
+  d.axes_pose_ = boost::make_shared<rviz::Axes>(scene_manager_, d.node_.get(), axes_length_property_->getFloat(), 
+          axes_radius_property_->getFloat());
+
+  d.arrow_vel_len_ = 1.0;
+  d.arrow_vel_ = boost::make_shared<rviz::Arrow>(scene_manager_, d.node_.get(), velocity_arrow_length_scale_property_->getFloat(), 
+          velocity_arrow_radius_property_->getFloat(), velocity_arrow_head_length_property_->getFloat(), 
+          velocity_arrow_head_radius_property_->getFloat());
+
+  d.text_id_ = boost::make_shared<TextID>(scene_manager_, d.node_.get());
+  return d;
+}
+
+
+void Display::releaseTrack(display_object& d) {
+  // a detached node is not rendered
+  scene_node_->removeChild(d.node_.get());
+  track_pool_.push_back(d);
+}
+
+
 /* Class Text ID */
 TextID::TextID(Ogre::SceneManager* scene_manager, Ogre::SceneNode* parent_node){
   scene_manager_ = scene_manager;
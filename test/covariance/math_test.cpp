@@ -0,0 +1,229 @@
+#include <covariance/math.h>
+
+#include <gtest/gtest.h>
+
+#include <OgreMatrix3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace mrs_rviz_plugins::covariance;
+
+namespace
+{
+
+// The scales are floats, the variances computed from them are within this relative tolerance
+constexpr double variance_tolerance = 1e-6;
+
+// The closed-form solution loses about half of the digits of repeated eigenvalues, relative to the largest one
+constexpr double absolute_tolerance = 1e-8;
+
+// Eigenvalues of the reference closer than this, relative to the largest one, do not define the direction of their eigenvectors
+constexpr double direction_gap = 1e-3;
+
+class CovarianceGenerator {
+public:
+  explicit CovarianceGenerator(unsigned seed) : rng_(seed) {
+  }
+
+  Eigen::Matrix3d rotation() {
+    Eigen::Quaterniond q(normal_(rng_), normal_(rng_), normal_(rng_), normal_(rng_));
+    return q.normalized().toRotationMatrix();
+  }
+
+  Eigen::Matrix2d rotation2D() {
+    return Eigen::Rotation2Dd(uniform_(rng_) * 2.0 * M_PI).toRotationMatrix();
+  }
+
+  double logUniform(double min, double max) {
+    return std::exp(std::log(min) + uniform_(rng_) * (std::log(max) - std::log(min)));
+  }
+
+  /// A randomly rotated covariance with variances between 1e-4 and 1e2
+  Eigen::Matrix3d randomSpd() {
+    const Eigen::Vector3d variances(logUniform(1e-4, 1e2), logUniform(1e-4, 1e2), logUniform(1e-4, 1e2));
+    return rotate(variances);
+  }
+
+  /// A randomly rotated covariance with a condition number between 1e4 and 1e15, such as the ones of GPS-like sources
+  Eigen::Matrix3d nearSingular() {
+    const double largest   = logUniform(1e-2, 1e6);
+    const double condition = logUniform(1e4, 1e15);
+    const Eigen::Vector3d variances(largest / condition, largest / condition * logUniform(1.0, 1e2), largest);
+    return rotate(variances);
+  }
+
+  /// A rotated covariance of rank one or two
+  Eigen::Matrix3d singular() {
+    const Eigen::Vector3d variances(0.0, uniform_(rng_) < 0.5 ? 0.0 : logUniform(1e-4, 1e2), logUniform(1e-4, 1e2));
+    return rotate(variances);
+  }
+
+  /// An axis-aligned covariance, some of the variances may be equal
+  Eigen::Matrix3d diagonal() {
+    Eigen::Vector3d variances(logUniform(1e-4, 1e2), logUniform(1e-4, 1e2), logUniform(1e-4, 1e2));
+    if (uniform_(rng_) < 0.3)
+      variances[1] = variances[0];
+    if (uniform_(rng_) < 0.3)
+      variances[2] = variances[0];
+    return variances.asDiagonal();
+  }
+
+  Eigen::Matrix2d randomSpd2D() {
+    const Eigen::Vector2d variances(logUniform(1e-4, 1e2), logUniform(1e-4, 1e2));
+    const Eigen::Matrix2d r = rotation2D();
+    return r * variances.asDiagonal() * r.transpose();
+  }
+
+  Eigen::Matrix2d nearSingular2D() {
+    const double          largest = logUniform(1e-2, 1e6);
+    const Eigen::Vector2d variances(largest / logUniform(1e4, 1e15), largest);
+    const Eigen::Matrix2d r = rotation2D();
+    return r * variances.asDiagonal() * r.transpose();
+  }
+
+private:
+  Eigen::Matrix3d rotate(const Eigen::Vector3d& variances) {
+    const Eigen::Matrix3d r = rotation();
+    Eigen::Matrix3d       covariance = r * variances.asDiagonal() * r.transpose();
+    // exactly symmetric, as published covariances are
+    return (covariance + covariance.transpose()) / 2.0;
+  }
+
+  std::mt19937                           rng_;
+  std::normal_distribution<double>       normal_;
+  std::uniform_real_distribution<double> uniform_;
+};
+
+template <int N>
+void expectMatchesReference(const Eigen::Matrix<double, N, N>& covariance, const Ogre::Vector3& scale, const Ogre::Quaternion& orientation) {
+  // the iterative solver is the reference, the shape has to be its eigendecomposition up to the order of the axes
+  Eigen::SelfAdjointEigenSolver<Eigen::Matrix<double, N, N>> reference;
+  reference.compute(covariance);
+  ASSERT_EQ(reference.info(), Eigen::Success);
+  const Eigen::Matrix<double, N, 1> eigenvalues = reference.eigenvalues().cwiseMax(0.0);
+  const double                      largest     = eigenvalues.maxCoeff();
+
+  Ogre::Matrix3 rotation;
+  orientation.ToRotationMatrix(rotation);
+  EXPECT_NEAR(rotation.Determinant(), 1.0, 1e-5) << "the axes are not right-handed";
+
+  for (int axis = 0; axis < N; axis++) {
+    ASSERT_TRUE(std::isfinite(scale[axis]) && scale[axis] >= 0.0) << "scale " << scale << " of\n" << covariance;
+
+    // the eigenvalue the axis belongs to, the scales are two standard deviations
+    const double variance = std::pow(scale[axis] / 2.0, 2);
+    int          index    = 0;
+    for (int it = 1; it < N; it++)
+      if (std::abs(eigenvalues[it] - variance) < std::abs(eigenvalues[index] - variance))
+        index = it;
+    EXPECT_NEAR(variance, eigenvalues[index], variance_tolerance * eigenvalues[index] + absolute_tolerance * largest)
+        << "scale " << scale << " of\n" << covariance;
+
+    double gap = std::numeric_limits<double>::infinity();
+    for (int it = 0; it < N; it++)
+      if (it != index)
+        gap = std::min(gap, std::abs(eigenvalues[it] - eigenvalues[index]));
+    if (gap <= direction_gap * largest)
+      continue;
+
+    const Ogre::Vector3 column = rotation.GetColumn(axis);
+    double              dot    = 0.0;
+    for (int it = 0; it < N; it++)
+      dot += column[it] * reference.eigenvectors()(it, index);
+    EXPECT_GT(std::abs(dot), 1.0 - 1e-5) << "axis " << axis << " of the orientation of\n" << covariance;
+  }
+}
+
+void check3D(const Eigen::Matrix3d& covariance) {
+  Ogre::Vector3    scale;
+  Ogre::Quaternion orientation;
+  computeShapeScaleAndOrientation3D(covariance, scale, orientation);
+  expectMatchesReference<3>(covariance, scale, orientation);
+}
+
+void check2D(const Eigen::Matrix2d& covariance) {
+  Ogre::Vector3    scale;
+  Ogre::Quaternion orientation;
+  computeShapeScaleAndOrientation2D(covariance, scale, orientation, XY_PLANE);
+  EXPECT_EQ(scale.z, 0.0);
+  expectMatchesReference<2>(covariance, scale, orientation);
+}
+
+}  // namespace
+
+TEST(CovarianceMath, RandomSpd3D) {
+  CovarianceGenerator generator(1);
+  for (int it = 0; it < 20000; it++)
+    check3D(generator.randomSpd());
+}
+
+TEST(CovarianceMath, NearSingular3D) {
+  CovarianceGenerator generator(2);
+  for (int it = 0; it < 20000; it++)
+    check3D(generator.nearSingular());
+}
+
+TEST(CovarianceMath, GpsLike3D) {
+  // the case computeDirect() alone got a negative eigenvalue for
+  CovarianceGenerator   generator(3);
+  const Eigen::Vector3d variances(1e-9, 1e-9, 1e6);
+  for (int it = 0; it < 20000; it++) {
+    const Eigen::Matrix3d r = generator.rotation();
+    check3D(r * variances.asDiagonal() * r.transpose());
+  }
+}
+
+TEST(CovarianceMath, Singular3D) {
+  CovarianceGenerator generator(4);
+  for (int it = 0; it < 20000; it++)
+    check3D(generator.singular());
+  check3D(Eigen::Matrix3d::Zero());
+}
+
+TEST(CovarianceMath, Diagonal3D) {
+  CovarianceGenerator generator(5);
+  for (int it = 0; it < 20000; it++)
+    check3D(generator.diagonal());
+  check3D(Eigen::Matrix3d::Identity());
+}
+
+TEST(CovarianceMath, Shapes2D) {
+  CovarianceGenerator generator(6);
+  for (int it = 0; it < 20000; it++) {
+    check2D(generator.randomSpd2D());
+    check2D(generator.nearSingular2D());
+  }
+  check2D(Eigen::Matrix2d::Zero());
+  check2D(Eigen::Matrix2d::Identity());
+  check2D(Eigen::Vector2d(1e-9, 1e6).asDiagonal());
+}
+
+TEST(CovarianceMath, MakeRightHanded) {
+  CovarianceGenerator generator(7);
+  for (int it = 0; it < 1000; it++) {
+    Eigen::Matrix3d eigenvectors = generator.rotation();
+    eigenvectors.col(0) *= -1.0;
+    Eigen::Vector3d eigenvalues(1.0, 2.0, 3.0);
+    makeRightHanded(eigenvectors, eigenvalues);
+    EXPECT_NEAR(eigenvectors.determinant(), 1.0, 1e-12);
+    // the swapped columns keep their eigenvalues
+    EXPECT_EQ(eigenvalues, Eigen::Vector3d(2.0, 1.0, 3.0));
+  }
+}
+
+TEST(CovarianceMath, RadianScaleToMetricScaleBounded) {
+  const float max_degrees = 89.0;
+  for (double radians = 0.0; radians < 10.0; radians += 0.01) {
+    Ogre::Real scale = radians;
+    radianScaleToMetricScaleBounded(scale, max_degrees);
+    EXPECT_NEAR(scale, 2.0 * std::tan(std::min(radians / 2.0, deg2rad(max_degrees))), 1e-4 * scale + 1e-6);
+  }
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}